@@ -10,22 +10,41 @@
     #include "sy_parser/AST.h"
     #include "sy_parser/symbol_table.h"
 
-    extern int yylineno;
-    extern FILE *yyin;
+    // 最近一次解析得到的语法树，由调用解析入口(parse.h)的一方设置
     ASTNodePtr root;
 
-    extern int yylex(void);
-    void yyerror(const char *s);
+    // 行号取自当前解析所用的扫描器
+    #define yylineno yyget_lineno(scanner)
+
+    extern int yylex(YYSTYPE *yylval_param, yyscan_t scanner);
+    extern int yyget_lineno(yyscan_t scanner);
+    void yyerror(yyscan_t scanner, ASTNodePtr *result, const char *s);
 
     SymbolType node_type_to_sym_type(NodeType node_type);
     ASTNodePtr initer_process(SymbolPtr symbol, ASTNodePtr initer);
-    SymbolPtr var_def(ASTNodePtr var_node, DataType data_type);
-    ASTNodePtr function_def(char *name, DataType type, ASTNodePtr params);
+    SymbolPtr var_def(ASTNodePtr var_node, DataType data_type, int lineno);
+    ASTNodePtr function_def(char *name, DataType type, ASTNodePtr params,
+                            int lineno);
     ASTNodePtr get_const_value(ASTNodePtr node);
     ASTNodePtr fold_unary_exp(ASTNodePtr node);
     ASTNodePtr fold_binary_exp(ASTNodePtr node);
+    ASTNodePtr simplify_unary_exp(ASTNodePtr node);
+    ASTNodePtr simplify_binary_exp(ASTNodePtr node);
+    ASTNodePtr simplify_condition(ASTNodePtr node);
 %}
 
+%code requires {
+    #ifndef YY_TYPEDEF_YY_SCANNER_T
+    #define YY_TYPEDEF_YY_SCANNER_T
+    typedef void *yyscan_t;
+    #endif
+    struct ASTNode;
+}
+
+%define api.pure full
+%param {yyscan_t scanner}
+%parse-param {struct ASTNode **result}
+
 %union {
     char *str;
     struct ASTNode *node;
@@ -37,6 +56,7 @@
 %token LEQUAL GEQUAL EQUAL NEQUAL AND OR
 %token INT FLOAT VOID CONST IF ELSE WHILE BREAK CONTINUE RETURN
 %token ENDMARKER
+%token PROGRAM_START BODY_START
 
 %type <node> file CompUnit Decl BType DimBrackets ConstDimBrackets
 %type <node> ConstDecl ConstDefList ConstDef ConstInitVal ConstInitValList ConstExp
@@ -48,8 +68,10 @@
 
 %%
 
+// 扫描器先返回起始记号选择入口：整个程序，或并行解析时单独的一个函数体
 file:
-    CompUnit ENDMARKER { root = $1; YYACCEPT; }
+    PROGRAM_START CompUnit ENDMARKER { *result = $2; YYACCEPT; }
+    | BODY_START Block ENDMARKER { *result = $2; YYACCEPT; }
     ;
 
 CompUnit:
@@ -108,7 +130,7 @@ ConstDecl:
 
 ConstDefList:
     CONST BType ConstDef {
-        var_def($3, $2->data.data_type);
+        var_def($3, $2->data.data_type, yylineno);
         $$ = create_ast_node(NODE_LIST, "ConstDefs", yylineno, 1, $3);
     }
     | ConstDefList ',' ConstDef {
@@ -116,7 +138,7 @@ ConstDefList:
         if ($1->children[0])
             if ($1->children[0]->data.symb_ptr)
                 data_type = $1->children[0]->data.symb_ptr->data_type;
-        var_def($3, data_type);
+        var_def($3, data_type, yylineno);
         add_child($1, $3);
         $$ = $1;
     }
@@ -148,7 +170,7 @@ VarDecl:
 
 VarDefList:
     BType VarDef {
-        var_def($2, $1->data.data_type);
+        var_def($2, $1->data.data_type, yylineno);
         $$ = create_ast_node(NODE_LIST, "VarDefs", yylineno, 1, $2);
     }
     | VarDefList ',' VarDef {
@@ -157,7 +179,7 @@ VarDefList:
             if ($1->children[0]->data.symb_ptr)
                 data_type = $1->children[0]->data.symb_ptr->data_type;
         }
-        var_def($3, data_type);
+        var_def($3, data_type, yylineno);
         add_child($1, $3);
         $$ = $1;
     }
@@ -196,12 +218,12 @@ FuncDef:
 
 FuncHead:
     BType IDENTIFIER '(' FuncFParams ')' {
-        $$ = function_def($2, $1->data.data_type, $4);
+        $$ = function_def($2, $1->data.data_type, $4, yylineno);
         if ($$->data_type == NODEDATA_SYMB && $$->data.symb_ptr)
             enter_function($$->data.symb_ptr);
     }
     | VOID IDENTIFIER '(' FuncFParams ')' {
-        $$ = function_def($2, DATA_VOID, $4);
+        $$ = function_def($2, DATA_VOID, $4, yylineno);
         if ($$->data_type == NODEDATA_SYMB && $$->data.symb_ptr)
             enter_function($$->data.symb_ptr);
     }
@@ -296,7 +318,7 @@ Stmt:
     ;
 
 Cond:
-    LOrExp { $$ = $1; }
+    LOrExp { $$ = simplify_exps ? simplify_condition($1) : $1; }
     ;
 
 Exp:
@@ -312,7 +334,7 @@ LVal:
         SymbolPtr sym = lookup_symbol($1);
         NodeData data;
         if (!sym) {
-            yyerror("Undeclared identifier");
+            yyerror(scanner, result, "Undeclared identifier");
             YYERROR;
         }
         data.symb_ptr = sym;
@@ -330,17 +352,18 @@ LVal:
                 $$ = create_ast_node(NODE_CONST_ARRAY, NULL, yylineno, 0);
                 break;
             default:
-                yyerror("Invalid symbol type");
+                yyerror(scanner, result, "Invalid symbol type");
                 YYERROR; 
                 break;
         }
+        count_symbol_ref(sym, 1);
         set_ast_node_data($$, HOLD_NODETYPE, NULL, data, NODEDATA_SYMB, -1);
     }
     | IDENTIFIER DimBrackets {
         SymbolPtr sym = lookup_symbol($1);
         NodeData data;
         if (!sym) {
-            yyerror("Undeclared identifier");
+            yyerror(scanner, result, "Undeclared identifier");
             YYERROR;
         }
         data.symb_ptr = sym;
@@ -354,10 +377,11 @@ LVal:
                     $2, NODE_CONST_ARRAY_ACCESS, NULL, data, NODEDATA_SYMB, yylineno);
                 break;
             default:
-                yyerror("Invalid symbol type");
+                yyerror(scanner, result, "Invalid symbol type");
                 YYERROR;
                 break;
         }
+        count_symbol_ref(sym, 1);
         $$ = $2;
     }
     | STRING_CONST {
@@ -401,10 +425,10 @@ UnaryExp:
         SymbolPtr sym = lookup_symbol($1);
         NodeData data;
         if (!sym) {
-            yyerror("Undeclared function");
+            yyerror(scanner, result, "Undeclared function");
             YYERROR;
         }
-        sym->attributes.func_info.call_count++;
+        count_function_call(sym, 1);
         data.symb_ptr = sym;
         // 单独处理starttime(__LINE__)和stoptime(__LINE__)
         if (strcmp($1, "starttime") == 0 || strcmp($1, "stoptime") == 0) {
@@ -513,7 +537,10 @@ LOrExp:
 
 %%
 
-void yyerror(const char *s) {
+void yyerror(yyscan_t scanner, ASTNodePtr *result, const char *s) {
+    (void)result;
+    // 试探性解析失败后会整体重新解析，由那次解析报错
+    if (is_speculative_parse()) return;
     fprintf(stderr, "%d %s\n", yylineno, s);
 }
 
@@ -534,7 +561,9 @@ SymbolType node_type_to_sym_type(NodeType node_type) {
 
 // 辅助函数：计算数组第dim_start维之后的总大小
 int calculate_array_size(SymbolPtr symbol, int dim_start) {
-    if (symbol->symbol_type != SYMB_ARRAY) return 1;
+    if (symbol->symbol_type != SYMB_ARRAY &&
+        symbol->symbol_type != SYMB_CONST_ARRAY)
+        return 1;
     int output = 1;
     ArrayInfo array_info = symbol->attributes.array_info;
     for (int i = dim_start; i < array_info.dimensions; i++)
@@ -544,12 +573,13 @@ int calculate_array_size(SymbolPtr symbol, int dim_start) {
 
 // 辅助函数：补全初始化器隐含的维度
 ASTNodePtr recursive_reshape_initer(ASTNodePtr initer, SymbolPtr symbol,
-                                    int current_dim, const char *name) {
+                                    int current_dim, const char *name,
+                                    int lineno) {
     if (!initer) return NULL;
     if (current_dim >= symbol->attributes.array_info.dimensions - 1)
         return initer;
 
-    ASTNodePtr output = create_ast_node(NODE_LIST, my_strdup(name), yylineno, 0);
+    ASTNodePtr output = create_ast_node(NODE_LIST, my_strdup(name), lineno, 0);
     ASTNodePtr piece;
     int current_array_size = calculate_array_size(symbol, current_dim + 1);
     int acc_item_num = 0;
@@ -561,7 +591,7 @@ ASTNodePtr recursive_reshape_initer(ASTNodePtr initer, SymbolPtr symbol,
             initer->children[i] = NULL;
         } else {
             if (!acc_item_num)
-                piece = create_ast_node(NODE_LIST, my_strdup(name), yylineno, 0);
+                piece = create_ast_node(NODE_LIST, my_strdup(name), lineno, 0);
             add_child(piece, child);
             initer->children[i] = NULL;
             acc_item_num++;
@@ -575,11 +605,11 @@ ASTNodePtr recursive_reshape_initer(ASTNodePtr initer, SymbolPtr symbol,
     free_ast(initer);
     for (int i = 0; i < output->child_count; i++)
         output->children[i] = recursive_reshape_initer(
-            output->children[i], symbol, current_dim + 1, name);
+            output->children[i], symbol, current_dim + 1, name, lineno);
     return output;
 }
 
-SymbolPtr var_def(ASTNodePtr var_node, DataType data_type) {
+SymbolPtr var_def(ASTNodePtr var_node, DataType data_type, int lineno) {
     if (!var_node) return NULL;
 
     NodeData data;
@@ -635,13 +665,27 @@ SymbolPtr var_def(ASTNodePtr var_node, DataType data_type) {
                         sym->attributes.array_info.elem_num * dim_size;
             }
 
+            init_array_strides(&sym->attributes.array_info);
+
             free_ast(dim_node);
             var_node->children[0] = NULL;
             // 可根据 valid 变量决定后续处理
             if (var_node->child_count > 1) {
                 ASTNodePtr initer = var_node->children[1];
-                var_node->children[1] = recursive_reshape_initer(
-                    initer, sym, 0, my_strdup(initer->name));
+                // 常量数组的初值记录在符号中，常量下标的读取可在解析时折叠
+                if (sym_type == SYMB_CONST_ARRAY)
+                    store_const_values(initer, data_type,
+                                       &sym->attributes.array_info);
+                // 大初始化器直接展平为紧凑的常量缓冲区，不再重组嵌套列表
+                if (packed_init_min > 0 &&
+                    count_initer_elements(initer) >= packed_init_min)
+                    var_node->children[1] = pack_initer(
+                        initer, data_type, dim_count,
+                        sym->attributes.array_info.shape,
+                        sym->attributes.array_info.elem_num);
+                else
+                    var_node->children[1] = recursive_reshape_initer(
+                        initer, sym, 0, my_strdup(initer->name), lineno);
             }
             break;
         default:
@@ -652,8 +696,9 @@ SymbolPtr var_def(ASTNodePtr var_node, DataType data_type) {
     return sym;
 }
 
-ASTNodePtr function_def(char *name, DataType type, ASTNodePtr params) {
-    SymbolPtr func_sym = define_symbol(name, SYMB_FUNCTION, type, yylineno);
+ASTNodePtr function_def(char *name, DataType type, ASTNodePtr params,
+                        int lineno) {
+    SymbolPtr func_sym = define_symbol(name, SYMB_FUNCTION, type, lineno);
     NodeData data;
     ASTNodePtr output;
     // var in loop
@@ -671,7 +716,7 @@ ASTNodePtr function_def(char *name, DataType type, ASTNodePtr params) {
                 param_node = params->children[i];
                 type_node = param_node->children[0];
                 var_node = param_node->children[1];
-                var_def(var_node, type_node->data.data_type);
+                var_def(var_node, type_node->data.data_type, lineno);
                 var_node->data.symb_ptr->function = func_sym;
                 func_sym->attributes.func_info.params[i] = var_node->data.symb_ptr;
 
@@ -682,20 +727,64 @@ ASTNodePtr function_def(char *name, DataType type, ASTNodePtr params) {
         }
     }
     data.symb_ptr = func_sym;
-    output = create_ast_node(NODE_FUNC_DEF, name, yylineno, 1, params);
+    output = create_ast_node(NODE_FUNC_DEF, name, lineno, 1, params);
     set_ast_node_data(output, HOLD_NODETYPE, NULL, data, NODEDATA_SYMB, -1);
     return output;
 }
 
+// 常量数组元素在初值中的位置：须有记录的初值且各下标都是范围内的整数常量，
+// 否则返回-1
+static int const_element_offset(ASTNodePtr node) {
+    ArrayInfo *array_info = &node->data.symb_ptr->attributes.array_info;
+    int offset = 0, index;
+
+    if (!array_info->values.ints || !array_info->strides) return -1;
+    if (node->child_count != array_info->dimensions) return -1;
+    for (int i = 0; i < node->child_count; i++) {
+        ASTNodePtr subscript = node->children[i];
+        if (!subscript || subscript->node_type != NODE_CONST ||
+            subscript->data_type != NODEDATA_INT)
+            return -1;
+        index = subscript->data.direct_int;
+        if (index < 0 || index >= array_info->shape[i]) return -1;
+        offset += index * array_info->strides[i];
+    }
+    return offset;
+}
+
 ASTNodePtr get_const_value(ASTNodePtr node) {
     SymbolPtr sym = NULL;
     ASTNodePtr valued = NULL;
     NodeData data;
+    ArrayInfo *array_info;
+    int offset;
 
     if (!node) return node;
     if (!node->data.symb_ptr) return node;
     sym = node->data.symb_ptr;
 
+    if (node->node_type == NODE_CONST_ARRAY_ACCESS) {
+        offset = const_element_offset(node);
+        if (offset < 0) return node;
+        array_info = &sym->attributes.array_info;
+        valued = create_ast_node(NODE_CONST, NULL, node->lineno, 0);
+        if (sym->data_type == DATA_FLOAT) {
+            data.direct_float = offset < array_info->value_count
+                                    ? array_info->values.floats[offset]
+                                    : 0;
+            set_ast_node_data(valued, HOLD_NODETYPE, NULL, data, NODEDATA_FLOAT, -1);
+        } else {
+            data.direct_int = offset < array_info->value_count
+                                  ? array_info->values.ints[offset]
+                                  : 0;
+            set_ast_node_data(valued, HOLD_NODETYPE, NULL, data, NODEDATA_INT, -1);
+        }
+        // 下标都是常量，折叠后不再有引用
+        count_symbol_ref(sym, -1);
+        free_ast(node);
+        return valued;
+    }
+
     if (node->node_type == NODE_CONST_VAR) {
         if (sym->data_type == DATA_INT) {
             valued = create_ast_node(NODE_CONST, NULL, node->lineno, 0);
@@ -706,6 +795,10 @@ ASTNodePtr get_const_value(ASTNodePtr node) {
             data.direct_float = sym->attributes.const_info.float_value;
             set_ast_node_data(valued, HOLD_NODETYPE, NULL, data, NODEDATA_FLOAT, -1);
         }
+        if (valued) {
+            count_symbol_ref(sym, -1);
+            free_ast(node);
+        }
         return valued;
     }
     return node;
@@ -747,10 +840,12 @@ ASTNodePtr fold_unary_exp(ASTNodePtr node) {
                 data.direct_int = int_result;
                 set_ast_node_data(folded, HOLD_NODETYPE, NULL, data, NODEDATA_INT, -1);
             }
+            free_ast(node);
             return folded;
         }
     }
 
+    if (simplify_exps) return simplify_unary_exp(node);
     return node;
 }
 
@@ -864,9 +959,285 @@ ASTNodePtr fold_binary_exp(ASTNodePtr node) {
                 data.direct_int = int_result;
                 set_ast_node_data(folded, HOLD_NODETYPE, NULL, data, NODEDATA_INT, -1);
             }
+            free_ast(node);
             return folded;
         }
     }
 
+    if (simplify_exps) return simplify_binary_exp(node);
+    return node;
+}
+
+// 表达式结果的类型：比较与逻辑运算的结果为DATA_BOOL（i1），
+// 无法确定时为DATA_UNKNOWN
+static DataType exp_data_type(ASTNodePtr node) {
+    DataType lhs_type, rhs_type;
+
+    if (!node) return DATA_UNKNOWN;
+    switch (node->node_type) {
+        case NODE_CONST:
+            if (node->data_type == NODEDATA_INT) return DATA_INT;
+            if (node->data_type == NODEDATA_FLOAT) return DATA_FLOAT;
+            return DATA_UNKNOWN;
+        case NODE_VAR:
+        case NODE_ARRAY_ACCESS:
+        case NODE_CONST_ARRAY_ACCESS:
+        case NODE_FUNC_CALL:
+            if (node->data_type != NODEDATA_SYMB || !node->data.symb_ptr)
+                return DATA_UNKNOWN;
+            return node->data.symb_ptr->data_type;
+        case NODE_UNARY_OP:
+            if (node->child_count < 1) return DATA_UNKNOWN;
+            lhs_type = exp_data_type(node->children[0]);
+            // 对i32取!的结果仍是i32，对浮点数取!不作处理
+            if (strcmp(node->name, "!") == 0 && lhs_type == DATA_FLOAT)
+                return DATA_UNKNOWN;
+            return lhs_type;
+        case NODE_BINARY_OP:
+            if (node->child_count < 2) return DATA_UNKNOWN;
+            if (strcmp(node->name, "+") && strcmp(node->name, "-") &&
+                strcmp(node->name, "*") && strcmp(node->name, "/") &&
+                strcmp(node->name, "%"))
+                return DATA_BOOL;
+            lhs_type = exp_data_type(node->children[0]);
+            rhs_type = exp_data_type(node->children[1]);
+            if (lhs_type == DATA_UNKNOWN || rhs_type == DATA_UNKNOWN)
+                return DATA_UNKNOWN;
+            if (lhs_type == DATA_FLOAT || rhs_type == DATA_FLOAT)
+                return DATA_FLOAT;
+            return DATA_INT;
+        default:
+            return DATA_UNKNOWN;
+    }
+}
+
+// 求值是否可能有副作用：函数调用一律视为有副作用
+static bool exp_has_side_effects(ASTNodePtr node) {
+    if (!node) return false;
+    if (node->node_type == NODE_FUNC_CALL) return true;
+    for (int i = 0; i < node->child_count; i++)
+        if (exp_has_side_effects(node->children[i])) return true;
+    return false;
+}
+
+// 被删除的子树中的调用不再计入被调函数的call_count，
+// 这样只在被删除代码中调用的库函数不会再被声明；
+// 其中的变量引用也不再计入ref_count
+static void uncount_refs(ASTNodePtr node) {
+    if (!node) return;
+    if (node->data_type == NODEDATA_SYMB && node->data.symb_ptr) {
+        if (node->node_type == NODE_FUNC_CALL)
+            count_function_call(node->data.symb_ptr, -1);
+        else
+            count_symbol_ref(node->data.symb_ptr, -1);
+    }
+    for (int i = 0; i < node->child_count; i++)
+        uncount_refs(node->children[i]);
+}
+
+static void discard_exp(ASTNodePtr node) {
+    uncount_refs(node);
+    free_ast(node);
+}
+
+// 用第index个子节点替换node，删除其余部分
+static ASTNodePtr keep_child(ASTNodePtr node, int index) {
+    ASTNodePtr child = node->children[index];
+    node->children[index] = NULL;
+    discard_exp(node);
+    return child;
+}
+
+static ASTNodePtr create_int_const(int value, int lineno) {
+    NodeData data;
+    ASTNodePtr output = create_ast_node(NODE_CONST, NULL, lineno, 0);
+    data.direct_int = value;
+    set_ast_node_data(output, HOLD_NODETYPE, NULL, data, NODEDATA_INT, -1);
+    return output;
+}
+
+static bool is_int_const(ASTNodePtr node, int *value) {
+    if (!node || node->node_type != NODE_CONST ||
+        node->data_type != NODEDATA_INT)
+        return false;
+    if (value) *value = node->data.direct_int;
+    return true;
+}
+
+// 常量的真值，不是常量时为-1
+static int const_truth(ASTNodePtr node) {
+    if (!node || node->node_type != NODE_CONST) return -1;
+    if (node->data_type == NODEDATA_INT) return node->data.direct_int != 0;
+    if (node->data_type == NODEDATA_FLOAT)
+        return node->data.direct_float != 0;
+    return -1;
+}
+
+// 按补码回绕计算，避免有符号溢出
+static int wrap_add(int lhs, int rhs) {
+    return (int)((unsigned)lhs + (unsigned)rhs);
+}
+
+static int wrap_mul(int lhs, int rhs) {
+    return (int)((unsigned)lhs * (unsigned)rhs);
+}
+
+static int wrap_neg(int value) { return (int)(0u - (unsigned)value); }
+
+// 把 (x op c1) op c2 中的两个整数常量合并，x须为int；不能合并时返回NULL
+static ASTNodePtr reassociate_consts(ASTNodePtr node) {
+    ASTNodePtr inner = node->children[0], term, output;
+    int outer_const, inner_const, term_index, merged;
+    bool is_mul = strcmp(node->name, "*") == 0;
+    bool negate_term = false;
+    const char *op = node->name;
+
+    if (!is_int_const(node->children[1], &outer_const)) return NULL;
+    if (!inner || inner->node_type != NODE_BINARY_OP) return NULL;
+    if (is_mul ? strcmp(inner->name, "*") != 0
+               : strcmp(inner->name, "+") && strcmp(inner->name, "-"))
+        return NULL;
+    if (is_int_const(inner->children[1], &inner_const)) {
+        term_index = 0;
+        if (strcmp(inner->name, "-") == 0) inner_const = wrap_neg(inner_const);
+    } else if (is_int_const(inner->children[0], &inner_const)) {
+        term_index = 1;
+        negate_term = strcmp(inner->name, "-") == 0;
+    } else {
+        return NULL;
+    }
+    term = inner->children[term_index];
+    if (exp_data_type(term) != DATA_INT) return NULL;
+
+    if (is_mul) {
+        merged = wrap_mul(inner_const, outer_const);
+    } else {
+        if (strcmp(node->name, "-") == 0) outer_const = wrap_neg(outer_const);
+        merged = wrap_add(inner_const, outer_const);
+        op = "+";
+        // x + (-3) 写作 x - 3
+        if (!negate_term && merged < 0 && wrap_neg(merged) > 0) {
+            op = "-";
+            merged = wrap_neg(merged);
+        }
+    }
+
+    inner->children[term_index] = NULL;
+    if (negate_term)
+        // c1 - x 合并后为 (c1 ± c2) - x
+        output = create_ast_node(NODE_BINARY_OP, "-", node->lineno, 2,
+                                 create_int_const(merged, node->lineno), term);
+    else
+        output = create_ast_node(NODE_BINARY_OP, op, node->lineno, 2, term,
+                                 create_int_const(merged, node->lineno));
+    discard_exp(node);
+    return simplify_binary_exp(output);
+}
+
+// 一元表达式的代数化简：+x、-(-x)以及!!!x。!只能作用于算术表达式，
+// 单独的!!x的值为0或1，只在条件中才能化简为x
+ASTNodePtr simplify_unary_exp(ASTNodePtr node) {
+    ASTNodePtr child = node->children[0];
+    ASTNodePtr grandchild;
+
+    if (!child) return node;
+    if (strcmp(node->name, "+") == 0) return keep_child(node, 0);
+    if (child->node_type != NODE_UNARY_OP || strcmp(child->name, node->name))
+        return node;
+
+    grandchild = child->children[0];
+    if (strcmp(node->name, "-") == 0 && exp_data_type(grandchild) != DATA_INT)
+        return node;
+    if (strcmp(node->name, "!") == 0 &&
+        !(grandchild->node_type == NODE_UNARY_OP &&
+          strcmp(grandchild->name, "!") == 0))
+        return node;
+    keep_child(node, 0);
+    return keep_child(child, 0);
+}
+
+// 条件只关心真假，去掉整数前成对的!（浮点数作条件时按转成int处理，
+// 与!!的结果不同）
+ASTNodePtr simplify_condition(ASTNodePtr node) {
+    ASTNodePtr child;
+
+    while (node && node->node_type == NODE_UNARY_OP &&
+           strcmp(node->name, "!") == 0) {
+        child = node->children[0];
+        if (!child || child->node_type != NODE_UNARY_OP ||
+            strcmp(child->name, "!") != 0 ||
+            exp_data_type(child->children[0]) != DATA_INT)
+            break;
+        keep_child(node, 0);
+        node = keep_child(child, 0);
+    }
     return node;
 }
+
+// 二元表达式的代数化简。被删除的操作数须没有副作用；
+// 短路运算中不会被求值的操作数直接删除
+ASTNodePtr simplify_binary_exp(ASTNodePtr node) {
+    ASTNodePtr lhs = node->children[0], rhs = node->children[1];
+    ASTNodePtr reassociated;
+    int lhs_truth, rhs_truth, lhs_const = 0, rhs_const = 0;
+    bool lhs_is_const, rhs_is_const, lhs_is_int, rhs_is_int;
+
+    if (!lhs || !rhs) return node;
+    if (strcmp(node->name, "&&") == 0 || strcmp(node->name, "||") == 0) {
+        node->children[0] = lhs = simplify_condition(lhs);
+        node->children[1] = rhs = simplify_condition(rhs);
+    }
+    lhs_truth = const_truth(lhs);
+    rhs_truth = const_truth(rhs);
+    lhs_is_const = is_int_const(lhs, &lhs_const);
+    rhs_is_const = is_int_const(rhs, &rhs_const);
+    lhs_is_int = exp_data_type(lhs) == DATA_INT;
+    rhs_is_int = exp_data_type(rhs) == DATA_INT;
+
+    if (strcmp(node->name, "&&") == 0) {
+        // 0 && e 与 1 && e
+        if (lhs_truth >= 0) return keep_child(node, lhs_truth ? 1 : 0);
+        if (rhs_truth == 1) return keep_child(node, 0);
+        if (rhs_truth == 0 && !exp_has_side_effects(lhs))
+            return keep_child(node, 1);
+        return node;
+    }
+    if (strcmp(node->name, "||") == 0) {
+        // 1 || e 与 0 || e
+        if (lhs_truth >= 0) return keep_child(node, lhs_truth ? 0 : 1);
+        if (rhs_truth == 0) return keep_child(node, 0);
+        if (rhs_truth == 1 && !exp_has_side_effects(lhs))
+            return keep_child(node, 1);
+        return node;
+    }
+
+    if (strcmp(node->name, "+") == 0) {
+        if (rhs_is_const && rhs_const == 0 && lhs_is_int)
+            return keep_child(node, 0);
+        if (lhs_is_const && lhs_const == 0 && rhs_is_int)
+            return keep_child(node, 1);
+    } else if (strcmp(node->name, "-") == 0) {
+        if (rhs_is_const && rhs_const == 0 && lhs_is_int)
+            return keep_child(node, 0);
+    } else if (strcmp(node->name, "*") == 0) {
+        if (rhs_is_const && rhs_const == 1 && lhs_is_int)
+            return keep_child(node, 0);
+        if (lhs_is_const && lhs_const == 1 && rhs_is_int)
+            return keep_child(node, 1);
+        if (rhs_is_const && rhs_const == 0 && lhs_is_int &&
+            !exp_has_side_effects(lhs))
+            return keep_child(node, 1);
+        if (lhs_is_const && lhs_const == 0 && rhs_is_int &&
+            !exp_has_side_effects(rhs))
+            return keep_child(node, 0);
+    } else if (strcmp(node->name, "/") == 0) {
+        if (rhs_is_const && rhs_const == 1 && lhs_is_int)
+            return keep_child(node, 0);
+        return node;
+    } else {
+        return node;
+    }
+
+    reassociated = reassociate_consts(node);
+    return reassociated ? reassociated : node;
+}
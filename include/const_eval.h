@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "sy_parser/AST.h"
+#include "sy_parser/symbol_table.h"
+}
+
+// 编译期求得的标量值
+struct ConstValue {
+    bool is_float = false;
+    int int_value = 0;
+    float float_value = 0;
+};
+
+// 在AST上解释执行函数调用，用于把常量实参的纯函数调用替换为结果。
+// 只支持标量局部变量与参数；读写全局变量、使用局部数组或数组参数、
+// 调用运行库函数、出现未定义行为，或超出步数、调用深度预算时求值失败。
+class ConstEvaluator {
+public:
+    // program为根节点，其中的函数定义可被求值
+    ConstEvaluator(ASTNodePtr program, int max_steps, int max_depth);
+
+    // 以常量实参调用func，成功时把返回值写入result
+    bool evaluate_call(SymbolPtr func, const std::vector<ConstValue>& args,
+                       ConstValue& result);
+
+private:
+    enum class Flow { Normal, Break, Continue, Return };
+
+    // 一次调用的局部变量：符号 -> 当前值，未赋值的变量不在其中
+    typedef std::unordered_map<SymbolPtr, ConstValue> Frame;
+
+    bool call(SymbolPtr func, std::vector<ConstValue> args,
+              ConstValue& result);
+    bool exec(ASTNodePtr node, Frame& frame, Flow& flow, ConstValue& ret);
+    bool eval(ASTNodePtr node, Frame& frame, ConstValue& value);
+    bool eval_condition(ASTNodePtr node, Frame& frame, bool& truth);
+    bool eval_binary(ASTNodePtr node, Frame& frame, ConstValue& value);
+    bool step();
+
+    std::unordered_map<SymbolPtr, ASTNodePtr> func_defs;
+    int max_steps;
+    int max_depth;
+    int steps = 0;
+    int depth = 0;
+
+    // 求值成功的调用结果：(函数, 实参的位表示) -> 返回值。
+    // 求值是确定的，失败的顶层求值中完成的子调用也可复用
+    std::map<std::pair<SymbolPtr, std::vector<uint32_t>>, ConstValue> results;
+};
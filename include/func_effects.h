@@ -0,0 +1,38 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+extern "C" {
+#include "sy_parser/AST.h"
+#include "sy_parser/symbol_table.h"
+}
+
+// 函数的副作用摘要，包含它直接或间接调用的函数的效果。
+// 读取全局常量数组的元素不算读全局变量（值在编译期已知且不会改变）
+struct FunctionEffects {
+    // 直接调用的函数（含运行库函数），不重复，按首次出现的顺序
+    std::vector<SymbolPtr> callees;
+    bool reads_globals = false;
+    bool writes_globals = false;
+    // 读写或作为实参传递过的全局数组
+    std::unordered_set<SymbolPtr> global_arrays;
+    // 写入过的全局变量与全局数组，包括作为实参传给写该形参的函数
+    std::unordered_set<SymbolPtr> stored_globals;
+    // 调用运行库的输入输出函数
+    bool does_io = false;
+    // 直接或间接调用自身
+    bool recursive = false;
+    // 按形参下标：是否通过数组形参读、写内存，以及调用期间经由该形参访问的
+    // 内存是否不会经由其它实参或全局数组访问。标量形参均为false
+    std::vector<bool> reads_param;
+    std::vector<bool> writes_param;
+    std::vector<bool> noalias_param;
+};
+
+// 源程序中定义的函数 -> 副作用摘要
+typedef std::unordered_map<SymbolPtr, FunctionEffects> EffectMap;
+
+// 根据整个程序的AST建立调用图并计算每个函数的副作用摘要
+EffectMap analyze_effects(ASTNodePtr program);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace midend {
+class BasicBlock;
+class Function;
+class Module;
+class Value;
+}  // namespace midend
+
+// 前端翻译while语句时记录的循环结构，中端的循环优化可直接使用，
+// 不必在大函数上重新计算支配树与循环分析
+struct LoopAnnotation {
+    // 循环头：每次迭代开始执行的块（while.N.cond，旋转形式为while.N.loop）
+    midend::BasicBlock* header = nullptr;
+    // 循环包含的基本块，按函数中的顺序，header在最前
+    std::vector<midend::BasicBlock*> blocks;
+    // 跳回header的块
+    std::vector<midend::BasicBlock*> latches;
+    // 出口块（while.N.merge），循环内只会跳出到这里；循环不会结束时为nullptr
+    midend::BasicBlock* exit = nullptr;
+    // 嵌套深度（最外层为1）及外层循环在同一函数记录中的下标，-1表示无
+    int depth = 1;
+    int parent = -1;
+
+    // 条件为 i < 常量，且每次迭代恰好执行一次 i = i + 1 时的归纳变量：
+    // i在栈上时为其alloca，直接构造SSA时为header中的phi，否则为nullptr
+    midend::Value* induction = nullptr;
+    int bound = 0;
+    // 进入循环时i为常量、且循环只能由条件退出时的迭代次数，否则为-1
+    int64_t trip_count = -1;
+};
+
+// 一个函数中的全部循环，外层循环在内层循环之前
+typedef std::vector<LoopAnnotation> FunctionLoops;
+
+// 查找函数的循环记录，没有时返回nullptr，此时需要中端自行分析。
+// 二进制IR（ir_serialize.h）与IR缓存会保存这些记录
+const FunctionLoops* get_loop_annotations(const midend::Module* module,
+                                          const midend::Function* func);
+
+// 替换函数的循环记录
+void set_loop_annotations(const midend::Module* module,
+                          const midend::Function* func, FunctionLoops loops);
+
+// 前端分析得到的形参属性，含义同LLVM的同名属性，只用于数组（指针）形参
+struct ParamAttributes {
+    // 调用期间经由该形参访问的内存不会经由其它实参或全局数组访问
+    bool noalias = false;
+    // 不会经由该形参写内存
+    bool readonly = false;
+};
+
+// 前端分析得到的函数属性，含义同LLVM的同名属性。调用其它函数时
+// 已包含被调函数的效果，中端可据此外提或合并调用而不必做过程间分析
+struct FunctionAttributes {
+    // 不读写调用者可见的内存（全局变量与数组实参），不做输入输出
+    bool readnone = false;
+    // 不写调用者可见的内存，不做输入输出
+    bool readonly = false;
+    // 不会直接或间接调用自身
+    bool norecurse = false;
+    // 按形参下标
+    std::vector<ParamAttributes> params;
+};
+
+// 查找函数的属性，没有时返回nullptr
+const FunctionAttributes* get_function_attributes(
+    const midend::Module* module, const midend::Function* func);
+
+// 替换函数的属性
+void set_function_attributes(const midend::Module* module,
+                             const midend::Function* func,
+                             FunctionAttributes attributes);
+
+// 前端估计的函数栈帧大小，只计局部变量与数组的alloca，
+// 不含寄存器溢出、调用参数等由后端决定的部分
+struct StackEstimate {
+    // 栈上局部变量与数组的总字节数
+    int64_t frame_bytes = 0;
+    // 其中最大的局部数组的字节数
+    int64_t largest_array_bytes = 0;
+    // 移到静态存储的局部数组的总字节数
+    int64_t static_bytes = 0;
+};
+
+// 查找函数的栈帧估计，没有时返回nullptr
+const StackEstimate* get_stack_estimate(const midend::Module* module,
+                                        const midend::Function* func);
+
+// 替换函数的栈帧估计
+void set_stack_estimate(const midend::Module* module,
+                        const midend::Function* func, StackEstimate estimate);
+
+// 启用裁剪时翻译跳过的函数与全局变量名，按在源程序中的顺序；
+// 没有记录时返回nullptr
+const std::vector<std::string>* get_pruned_definitions(
+    const midend::Module* module);
+
+// 替换模块的裁剪记录
+void set_pruned_definitions(const midend::Module* module,
+                            std::vector<std::string> names);
+
+// 删除模块的全部记录。记录按模块地址保存，释放模块前应调用，
+// 以免之后在同一地址创建的模块读到它们
+void clear_module_annotations(const midend::Module* module);
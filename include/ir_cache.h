@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "ir_gen.h"
+
+// 生成IR缓存的命中统计
+struct IRCacheStats {
+    int hits;
+    int misses;
+    int stores;
+    int errors;
+};
+
+// 由源文件内容与前端选项计算缓存键
+std::string ir_cache_key(const std::string& source,
+                         const FrontendOptions& options);
+
+// 查找缓存，未命中返回nullptr
+std::unique_ptr<midend::Module> ir_cache_load(const std::string& cache_dir,
+                                              const std::string& key);
+
+// 写入缓存（先写临时文件再原子rename，可多进程并发）
+bool ir_cache_store(const std::string& cache_dir, const std::string& key,
+                    midend::Module* module);
+
+const IRCacheStats& get_ir_cache_stats();
+void reset_ir_cache_stats();
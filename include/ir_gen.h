@@ -2,11 +2,123 @@
 
 #include <cstdio>
 #include <memory>
+#include <string>
+
+// Binary IR handoff to the midend
+#include "ir_serialize.h"
 
 namespace midend {
 class Module;
 }
 
+// How local arrays with an initializer are zero-filled
+enum class ArrayZeroFill {
+    // Zero every element with a runtime loop, then store the initializer
+    FullLoop,
+    // Zero only the elements the initializer leaves uncovered
+    Coverage,
+};
+
+// How the address of a multi-dimensional array element is computed
+enum class AddressLowering {
+    // One GEP per subscript
+    PerDimension,
+    // A single GEP carrying every subscript
+    MultiIndex,
+    // One GEP at a linear offset built from the strides in ArrayInfo;
+    // partial accesses (yielding a sub-array) fall back to MultiIndex
+    Flattened,
+};
+
+// Frontend options
+struct FrontendOptions {
+    bool enable_mangle_c_std_symbol = true;
+    // Directory of the generated IR cache, empty to disable caching
+    std::string cache_dir;
+    ArrayZeroFill array_zero_fill = ArrayZeroFill::FullLoop;
+    // With ArrayZeroFill::Coverage, uncovered ranges of at least this many
+    // elements are cleared with a memset call, 0 keeps runtime loops.
+    // Requires enable_mangle_c_std_symbol so memset cannot be user-defined.
+    int memset_threshold = 0;
+    // Local arrays whose initializer has at least this many non-zero
+    // constants are copied from an internal read-only template global with
+    // memcpy, 0 disables. Requires enable_mangle_c_std_symbol as well.
+    int array_template_min = 0;
+    // Array initializers with at least this many elements are stored as a
+    // flat packed buffer at parse time instead of nested lists, 0 disables
+    int packed_init_min = 1024;
+    AddressLowering address_lowering = AddressLowering::PerDimension;
+    // Fold constant subscripts and strides into one compile-time offset so
+    // only variable subscripts emit arithmetic (Flattened), and lower fully
+    // constant subscripts to a single constant-offset GEP (MultiIndex)
+    bool fold_array_offsets = false;
+    // Build SSA for scalar locals and parameters while lowering (Braun et
+    // al.): reads and writes become SSA values and phis instead of
+    // alloca/load/store. Arrays and globals stay in memory.
+    bool direct_ssa = false;
+    // Lower &&, || and ! in if/while conditions straight to conditional
+    // branches between the statement's blocks, without the i1 phi
+    bool branch_conditions = false;
+    // Lower while loops in rotated form: a guard test before the loop and a
+    // bottom test that branches back to the body (continue jumps to a latch
+    // block holding that test)
+    bool rotate_loops = false;
+    // Simplify expressions at parse time beyond constant folding: x*1, x+0,
+    // x*0 and the like on ints, constant short-circuit operands, double
+    // negation, ! on comparisons and reassociation of constants in (x+1)+2
+    bool simplify_exps = false;
+    // Replace calls whose arguments are all constants with their result
+    // when the callee can be evaluated at compile time: scalar locals only,
+    // no globals, arrays or runtime library calls, and at most this many
+    // evaluation steps per call site (0 disables) and const_eval_depth
+    // nested calls
+    int const_eval_steps = 0;
+    int const_eval_depth = 64;
+    // Memoize recursive functions that take only int parameters, return int
+    // and neither touch globals nor call the runtime library (directly or
+    // through callees). Each gets a global table of at most this many
+    // results (0 disables); calls with arguments outside the table's range
+    // run the body as usual
+    int memo_table_size = 0;
+    // Skip lowering of functions main cannot reach and of globals that no
+    // reachable function references. The skipped names are recorded on the
+    // module (get_pruned_definitions in ir_annotations.h)
+    bool prune_unreachable = false;
+    // Give locals that no expression refers to (never used, or every use
+    // folded to a constant) no stack slot and no initializer store, and skip
+    // the definitions of such const globals. Calls in a skipped initializer
+    // are still evaluated
+    bool elide_unused = false;
+    // Define non-const globals that are never stored to as constants with
+    // internal linkage: no assignment anywhere, and never passed as an array
+    // argument to a function that writes that parameter or to getarray and
+    // getfarray
+    bool detect_readonly_globals = true;
+    // Local arrays of at least this many bytes in main are placed in
+    // zero-initialized internal globals instead of on the stack, with their
+    // constant elements as the global's initializer (0 disables). Only
+    // arrays defined outside loops qualify, and only when main is never
+    // called, so each definition runs at most once. Per-function stack frame
+    // estimates are recorded on the module to help choose the threshold
+    // (get_stack_estimate in ir_annotations.h)
+    int static_array_min_bytes = 64 * 1024;
+    // Parse function bodies on up to this many threads once the globals and
+    // function signatures are parsed (0 or 1 parses serially). The AST and
+    // symbol table are the same as a serial parse produces, so the IR is too
+    int parse_threads = 0;
+};
+
+// Text identifying every option that affects the generated IR, used as part
+// of cache keys and fingerprints. New IR-affecting options must be added.
+std::string frontend_options_key(const FrontendOptions& options);
+
 // Integrate generator
 std::unique_ptr<midend::Module> generate_IR(
     FILE* file_in, bool enable_mangle_c_std_symbol = true);
+std::unique_ptr<midend::Module> generate_IR(FILE* file_in,
+                                            const FrontendOptions& options);
+
+// Generate IR from a binary AST image (see sy_parser/ast_serialize.h),
+// nullptr if the image is malformed
+std::unique_ptr<midend::Module> generate_IR_from_ast(
+    const void* data, size_t size, const FrontendOptions& options);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ir_gen.h"
+
+namespace midend {
+class Function;
+class GlobalVariable;
+}  // namespace midend
+
+// 增量编译状态：上一次生成的模块及其中各实体的指纹
+struct IncrementalState {
+    std::unique_ptr<midend::Module> module;
+
+    // 全局实体（全局变量与函数签名、用到的运行库函数）的摘要
+    uint64_t skeleton = 0;
+    // 源程序中的名字 -> 模块中的对象
+    std::unordered_map<std::string, midend::Function*> functions;
+    std::unordered_map<std::string, midend::GlobalVariable*> globals;
+    // 函数名 -> 函数指纹，全局变量名 -> 初值摘要
+    std::unordered_map<std::string, uint64_t> func_fingerprints;
+    std::unordered_map<std::string, uint64_t> global_values;
+
+    // 函数名 -> 函数体用到的按需创建的实体（memset/memcpy声明、模板、
+    // 静态数组、记忆化表），按第一次用到的顺序
+    std::unordered_map<std::string, std::vector<std::string>> lazy_entities;
+
+    IncrementalState() = default;
+    IncrementalState(IncrementalState&&) = default;
+    IncrementalState& operator=(IncrementalState&&) = default;
+    // 释放模块时一并删除其记录（ir_annotations.h）
+    ~IncrementalState();
+};
+
+struct IncrementalStats {
+    int reused;        // 沿用上一次结果的函数数
+    int relowered;     // 重新翻译的函数数
+    bool full_rebuild; // 全局实体发生变化，整个模块重新生成
+};
+
+// 按新源程序更新state中的模块：只重新翻译指纹变化的函数。
+// state为空时完整生成。解析失败返回false且不修改state。
+bool regenerate_IR(FILE* file_in, const FrontendOptions& options,
+                   IncrementalState& state, IncrementalStats* stats = nullptr);
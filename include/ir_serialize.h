@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace midend {
+class Module;
+}
+
+// 前端到中端的二进制IR交接格式，比IRPrinter文本更小、读取更快。
+// 全局变量与函数名总会保留；keep_local_names为false时省略基本块、指令
+// 和形参名称。
+
+// 将模块写为紧凑的二进制格式（追加到out）
+bool write_module_binary(midend::Module* module, std::string& out,
+                         bool keep_local_names = true);
+
+// 从二进制数据重建模块，数据损坏或不支持时返回nullptr
+std::unique_ptr<midend::Module> read_module_binary(const char* data,
+                                                   size_t size);
+
+// 文件读写
+bool write_module_binary_file(midend::Module* module, const char* path,
+                              bool keep_local_names = true);
+std::unique_ptr<midend::Module> read_module_binary_file(const char* path);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+extern "C" {
+#include "sy_parser/AST.h"
+}
+
+// 一次parse_source的情况
+struct ParallelParseStats {
+    int bodies;   // 在工作线程上解析的函数体数
+    bool serial;  // 整个程序串行解析：未要求多线程、函数不足两个或并行解析失败
+};
+
+// 解析内存中的整个程序到*result，成功返回0。threads大于1时先串行解析全局
+// 声明与函数签名（函数体替换为空块），再由最多threads个线程解析各函数体，
+// 最后把函数体的符号并入符号表并按串行解析的顺序重新编号，得到的语法树与
+// 符号表和串行解析的结果相同。任何一步失败都改为整体串行解析，报错也与
+// 串行解析一致。
+int parse_source(const std::string& source, int threads, ASTNodePtr* result,
+                 ParallelParseStats* stats = nullptr);
@@ -5,5 +5,8 @@
 // 添加运行时库函数到符号表
 void add_runtime_lib_to_symbol_table();
 
+// 从当前符号表（例如加载的二进制AST）中重新绑定运行时库函数符号
+void bind_runtime_lib_symbols();
+
 // 添加运行时库函数到函数记录表
 void add_runtime_lib_to_func_tab(midend::Module* module);
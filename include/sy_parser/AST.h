@@ -28,6 +28,7 @@ typedef enum {
     NODE_CONST_ARRAY_DEF,
     NODE_ARRAY_INIT_LIST,
     NODE_CONST_ARRAY_INIT_LIST,
+    NODE_PACKED_INIT,
     NODE_FUNC_DEF,
 
     // Statements
@@ -55,6 +56,22 @@ typedef enum {
     HOLD_NODETYPE,
 } NodeType;
 
+// Packed array initializer (NODE_PACKED_INIT), used instead of nested
+// NODE_LIST initializers for large arrays. Constant elements are stored in a
+// flat row-major buffer of elem_type; elements past length are zero. The
+// non-constant elements are the node's children, and expr_offsets[i] is the
+// flat offset of children[i].
+typedef struct PackedInit {
+    DataType elem_type;
+    int length;
+    int capacity;
+    union {
+        int* ints;
+        float* floats;
+    } values;
+    int* expr_offsets;
+} PackedInit, *PackedInitPtr;
+
 // Node Data
 typedef union {
     SymbolPtr symb_ptr;
@@ -62,6 +79,7 @@ typedef union {
     float direct_float;
     char* direct_str;
     DataType data_type;
+    PackedInitPtr packed;
 } NodeData;
 
 typedef enum {
@@ -71,6 +89,7 @@ typedef enum {
     NODEDATA_FLOAT,
     NODEDATA_STRING,
     NODEDATA_TYPE,
+    NODEDATA_PACKED,
 
     // Like HOLD_NODETYPE
     HOLD_NODEDATATYPE,
@@ -98,6 +117,26 @@ ASTNodePtr create_ast_node(NodeType type, const char* name, int lineno,
 // Delete AST node and its children recursively
 void free_ast(ASTNodePtr node);
 
+// Initializers with at least this many elements are packed at parse time
+// (0 disables packing)
+extern int packed_init_min;
+
+// Simplify algebraic identities and constant short-circuit operands while
+// folding expressions, not only operations on two constants
+extern bool simplify_exps;
+
+// Count the elements of a nested initializer list
+int count_initer_elements(ASTNodePtr initer);
+// Flatten a nested initializer list for an array of the given shape into a
+// NODE_PACKED_INIT node. Takes ownership of initer.
+ASTNodePtr pack_initer(ASTNodePtr initer, DataType elem_type, int dimensions,
+                       const int* shape, int elem_num);
+// Store the flattened values of a const array's nested initializer in
+// array_info (laid out as by pack_initer). Does nothing and returns false
+// if an element is not a constant. Does not take ownership of initer.
+bool store_const_values(ASTNodePtr initer, DataType elem_type,
+                        ArrayInfo* array_info);
+
 // - AST Edit Functions -
 
 // Set AST's node data (except data about children)
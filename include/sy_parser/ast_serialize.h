@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "sy_parser/AST.h"
+
+// --- Binary AST Serialization ---
+
+// The program (AST plus the whole symbol table) is stored as a header
+// followed by flat sections. Pointers are replaced by indices and offsets,
+// so the image is relocatable and can be loaded from a single read or mmap.
+
+// Serialize root and the current symbol table into a malloc'd buffer.
+// Returns 0 on success.
+int serialize_program(ASTNodePtr root, char** out, size_t* out_size);
+
+// Rebuild the AST and install its symbols into the symbol table, which must
+// be freshly initialized with init_symbol_management(). Returns the root,
+// or NULL if the image is malformed.
+ASTNodePtr deserialize_program(const void* data, size_t size);
+
+// File helpers: save returns 0 on success, load returns NULL on failure.
+int save_program(const char* path, ASTNodePtr root);
+ASTNodePtr load_program(const char* path);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "sy_parser/AST.h"
+
+// --- Parser Entry Points ---
+//
+// Implemented with the scanner (flex_yacc/sysy_flex.l). Each call uses its
+// own scanner, so parses on different threads do not interfere; the symbol
+// table state they use is per thread as well (symbol_table.h).
+
+// Parse a whole program into *result (NULL on failure). Return 0 on success,
+// as yyparse does.
+int parse_file(FILE* file_in, ASTNodePtr* result);
+int parse_buffer(const char* src, size_t len, ASTNodePtr* result);
+
+// Parse one function body, src holding its text from '{' to '}' and lineno
+// being the line of the '{'. The symbol table must be set up with
+// enter_function_body. *end_lineno is the line the scanner ended on.
+int parse_function_body(const char* src, size_t len, int lineno,
+                        ASTNodePtr* result, int* end_lineno);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+
+// --- Top-level Pre-scan ---
+
+// Kind of a top-level unit
+typedef enum {
+    UNIT_DECL,  // Global declaration, ends with ';'
+    UNIT_FUNC,  // Function definition, ends with the closing '}' of its body
+} UnitKind;
+
+// A top-level declaration or function definition found by the pre-scan
+typedef struct {
+    UnitKind kind;
+    size_t begin;       // Offset of the first significant character
+    size_t end;         // Offset one past the last character
+    size_t body_begin;  // Offset of the body's '{' (UNIT_FUNC only)
+    int lineno;         // Line number of begin
+    int body_lineno;    // Line number of body_begin (UNIT_FUNC only)
+    char* name;         // Function name (UNIT_FUNC only)
+} TopLevelUnit;
+
+typedef struct {
+    TopLevelUnit* units;
+    int unit_count;
+    int unit_capacity;
+} TopLevelUnits;
+
+// Split source into top-level units by brace matching, skipping comments and
+// string literals. Returns 0 on success, -1 on unbalanced brackets.
+int prescan_top_level(const char* src, size_t len, TopLevelUnits* out);
+void free_top_level_units(TopLevelUnits* units);
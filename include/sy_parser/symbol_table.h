@@ -34,8 +34,17 @@ typedef struct {
 // Information about an array symbol
 typedef struct {
     int* shape;  // An array representing the size of each dimension
+    int* strides;  // Elements skipped per step in each dimension, or NULL
     int dimensions;
     int elem_num;
+    // Row-major element values of a const array whose initializer is fully
+    // constant (ints or floats by the symbol's data_type), NULL otherwise.
+    // Elements from value_count on are zero.
+    union {
+        int* ints;
+        float* floats;
+    } values;
+    int value_count;
 } ArrayInfo;
 
 // Information about a function symbol
@@ -64,6 +73,9 @@ typedef struct Symbol {
 
     int lineno;
     int scope_level;  // The scope depth where the symbol is defined
+    // Expression nodes referring to the symbol (variables and arrays),
+    // not counting references folded to constants or simplified away
+    int ref_count;
 } Symbol, *SymbolPtr;
 
 // The global symbol table storing all symbols
@@ -75,6 +87,9 @@ typedef struct SymbolTable {
 
 // Lookup symbol in global symbol table
 SymbolPtr get_symbol_by_id(int id);
+// Append a symbol rebuilt outside define_symbol (e.g. by the AST loader),
+// assigning it the next id
+void restore_symbol(SymbolPtr symbol);
 
 // - Debugging -
 
@@ -86,10 +101,13 @@ void print_symbol_table();
 
 #define HASH_MAP_SIZE 256
 
-// An entry in a scope's symbol map (name -> symbol ID)
+// Scope level of globals and functions (the outermost scope)
+#define GLOBAL_SCOPE_LEVEL 1
+
+// An entry in a scope's symbol map (name -> symbol)
 typedef struct ScopeEntry {
     char* name;
-    int symbol_id;
+    SymbolPtr symbol;
     struct ScopeEntry* next;  // Simple linked list for hash collisions
 } ScopeEntry;
 
@@ -107,7 +125,8 @@ typedef struct ScopeStack {
     int capacity;
 } ScopeStack;
 
-// Symbol Table and Scope Management
+// Symbol Table and Scope Management. The scope stack, the current function
+// and the table of symbols being defined are per thread.
 void init_symbol_management();
 void free_symbol_management();
 
@@ -122,6 +141,78 @@ int get_current_scope_level();
 SymbolPtr define_symbol(const char* name, SymbolType sym_type,
                         DataType data_type, int lineno);
 
+// Fill array_info.strides from shape (row-major; an unknown first
+// dimension does not affect any stride)
+void init_array_strides(ArrayInfo* array_info);
+
 // Lookup symbol in scope table
 SymbolPtr lookup_symbol(const char* name);
 SymbolPtr lookup_symbol_in_current_scope(const char* name);
+
+// Record a reference to a symbol (delta 1) or drop one that was folded away
+// (delta -1), and likewise for calls to a function
+void count_symbol_ref(SymbolPtr symbol, int delta);
+void count_function_call(SymbolPtr func_symb, int delta);
+
+// While a parse is speculative, a redeclaration marks the parse as failed
+// instead of ending the process, and yyerror stays silent. Starting a
+// speculative parse clears the mark.
+void set_speculative_parse(bool speculative);
+bool is_speculative_parse();
+bool speculative_parse_failed();
+
+// Symbols defined so far and their counts, to undo a speculative parse
+typedef struct SymbolTableMark {
+    int symb_count;
+    int* ref_counts;
+    int* call_counts;
+} SymbolTableMark;
+
+SymbolTableMark mark_symbol_table();
+// Free the symbols defined after the mark, restore the counts of the others
+// and leave only the global scope, holding the remaining globals. Frees the
+// mark, as free_symbol_table_mark does when the parse is kept.
+void reset_symbol_table(SymbolTableMark* mark);
+void free_symbol_table_mark(SymbolTableMark* mark);
+
+// --- Parallel Body Parsing ---
+//
+// Once the globals and the function signatures are parsed, function bodies
+// can be parsed on worker threads. A worker shares the global scope of the
+// thread that parsed the signatures and only reads the symbols in it; the
+// references it counts on globals are kept aside until the merge. The
+// symbols a body defines get temporary ids until merge_body_symbols.
+
+// Symbols defined by one function body on a worker, in definition order
+typedef struct BodySymbols {
+    SymbolPtr func;
+    Symbol** symbols;
+    int symb_count;
+} BodySymbols;
+
+// Changes a worker made to ref_count and call_count of globals, by id
+typedef struct GlobalCounts {
+    int* ref_counts;
+    int* call_counts;
+    int symb_count;
+} GlobalCounts;
+
+Scope* get_global_scope();
+int get_symbol_count();
+
+// Set up the calling worker thread. global_count is the number of symbols
+// in the table of the thread owning global_scope.
+void begin_worker_symbols(Scope* global_scope, int global_count);
+GlobalCounts end_worker_symbols();
+
+// Open the body of func_symb: its parameters are in scope, and globals
+// defined after it are hidden as they are in a serial parse
+void enter_function_body(SymbolPtr func_symb);
+BodySymbols exit_function_body();
+
+// Insert the symbols of each body right after the parameters of its
+// function and number the whole table in that order, which is the order of
+// a serial parse. bodies must be in source order. Adds the workers' counts
+// and frees the arrays of both.
+void merge_body_symbols(BodySymbols* bodies, int body_count,
+                        GlobalCounts* counts, int counts_count);
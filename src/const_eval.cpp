@@ -0,0 +1,371 @@
+#include "const_eval.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+uint32_t value_bits(const ConstValue& value) {
+    uint32_t bits;
+    if (value.is_float)
+        std::memcpy(&bits, &value.float_value, sizeof(bits));
+    else
+        bits = (uint32_t)value.int_value;
+    return bits;
+}
+
+ConstValue make_int(int value) {
+    ConstValue output;
+    output.int_value = value;
+    return output;
+}
+
+ConstValue make_float(float value) {
+    ConstValue output;
+    output.is_float = true;
+    output.float_value = value;
+    return output;
+}
+
+// 转换为变量、参数或返回值的类型；浮点数超出int范围时为未定义行为
+bool convert(ConstValue& value, DataType data_type) {
+    if (data_type == DATA_FLOAT) {
+        if (!value.is_float) value = make_float((float)value.int_value);
+        return true;
+    }
+    if (data_type != DATA_INT) return false;
+    if (value.is_float) {
+        float truncated = std::trunc(value.float_value);
+        if (!(truncated >= (float)INT_MIN && truncated < -(float)INT_MIN))
+            return false;
+        value = make_int((int)truncated);
+    }
+    return true;
+}
+
+// 比较与逻辑运算的结果在IR中是i1
+bool is_bool_exp(ASTNodePtr node) {
+    static const char* ops[] = {"<", ">", "<=", ">=", "==", "!=", "&&", "||"};
+    if (!node || node->node_type != NODE_BINARY_OP || !node->name)
+        return false;
+    for (const char* op : ops)
+        if (strcmp(node->name, op) == 0) return true;
+    return false;
+}
+
+}  // namespace
+
+ConstEvaluator::ConstEvaluator(ASTNodePtr program, int max_steps,
+                               int max_depth)
+    : max_steps(max_steps), max_depth(max_depth) {
+    if (!program) return;
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNodePtr child = program->children[i];
+        if (child && child->node_type == NODE_FUNC_DEF &&
+            child->data_type == NODEDATA_SYMB && child->data.symb_ptr)
+            func_defs[child->data.symb_ptr] = child;
+    }
+}
+
+bool ConstEvaluator::evaluate_call(SymbolPtr func,
+                                   const std::vector<ConstValue>& args,
+                                   ConstValue& result) {
+    steps = 0;
+    depth = 0;
+    return call(func, args, result);
+}
+
+bool ConstEvaluator::step() { return ++steps <= max_steps; }
+
+bool ConstEvaluator::call(SymbolPtr func, std::vector<ConstValue> args,
+                          ConstValue& result) {
+    auto def_it = func_defs.find(func);
+    if (def_it == func_defs.end()) return false;  // 运行库函数
+    FuncInfo& info = func->attributes.func_info;
+    if ((int)args.size() != info.param_count) return false;
+    if (func->data_type != DATA_INT && func->data_type != DATA_FLOAT)
+        return false;
+
+    std::vector<uint32_t> key;
+    for (int i = 0; i < info.param_count; i++) {
+        if (info.params[i]->symbol_type != SYMB_VAR ||
+            !convert(args[i], info.params[i]->data_type))
+            return false;
+        key.push_back(value_bits(args[i]));
+    }
+    auto result_it = results.find({func, key});
+    if (result_it != results.end()) {
+        result = result_it->second;
+        return true;
+    }
+
+    if (depth >= max_depth) return false;
+    depth++;
+    Frame frame;
+    for (int i = 0; i < info.param_count; i++)
+        frame[info.params[i]] = args[i];
+    ASTNodePtr def = def_it->second;
+    Flow flow = Flow::Normal;
+    bool ok = def->child_count >= 2 &&
+              exec(def->children[1], frame, flow, result) &&
+              flow == Flow::Return && convert(result, func->data_type);
+    depth--;
+    if (ok) results[{func, key}] = result;
+    return ok;
+}
+
+bool ConstEvaluator::exec(ASTNodePtr node, Frame& frame, Flow& flow,
+                          ConstValue& ret) {
+    if (!node) return true;
+    if (!step()) return false;
+    ConstValue value;
+    bool truth;
+    switch (node->node_type) {
+        case NODE_EMPTY:
+        case NODE_CONST_VAR_DEF:
+        case NODE_CONST_ARRAY_DEF:
+            // 常量的读取已在解析时折叠
+            return true;
+        case NODE_LIST:
+            for (int i = 0; i < node->child_count; i++) {
+                if (!exec(node->children[i], frame, flow, ret)) return false;
+                if (flow != Flow::Normal) return true;
+            }
+            return true;
+        case NODE_VAR_DEF: {
+            SymbolPtr sym = node->data.symb_ptr;
+            if (!sym) return false;
+            // 没有初值的变量在赋值前不可读
+            frame.erase(sym);
+            if (node->child_count < 1 || !node->children[0]) return true;
+            if (!eval(node->children[0], frame, value) ||
+                !convert(value, sym->data_type))
+                return false;
+            frame[sym] = value;
+            return true;
+        }
+        case NODE_ASSIGN_STMT: {
+            if (node->child_count < 2) return false;
+            ASTNodePtr lval = node->children[0];
+            if (!lval || lval->node_type != NODE_VAR) return false;
+            SymbolPtr sym = lval->data.symb_ptr;
+            if (!sym || sym->scope_level == GLOBAL_SCOPE_LEVEL) return false;
+            if (!eval(node->children[1], frame, value) ||
+                !convert(value, sym->data_type))
+                return false;
+            frame[sym] = value;
+            return true;
+        }
+        case NODE_IF_STMT:
+        case NODE_IF_ELSE_STMT:
+            if (node->child_count < 2 ||
+                !eval_condition(node->children[0], frame, truth))
+                return false;
+            if (truth) return exec(node->children[1], frame, flow, ret);
+            if (node->node_type == NODE_IF_ELSE_STMT && node->child_count > 2)
+                return exec(node->children[2], frame, flow, ret);
+            return true;
+        case NODE_WHILE_STMT:
+            if (node->child_count < 2) return false;
+            while (true) {
+                if (!step() || !eval_condition(node->children[0], frame, truth))
+                    return false;
+                if (!truth) return true;
+                if (!exec(node->children[1], frame, flow, ret)) return false;
+                if (flow == Flow::Break) {
+                    flow = Flow::Normal;
+                    return true;
+                }
+                if (flow == Flow::Return) return true;
+                flow = Flow::Normal;
+            }
+        case NODE_BREAK_STMT:
+            flow = Flow::Break;
+            return true;
+        case NODE_CONTINUE_STMT:
+            flow = Flow::Continue;
+            return true;
+        case NODE_RETURN_STMT:
+            // void函数的调用不会被求值，return必须带返回值
+            if (node->child_count < 1 || !eval(node->children[0], frame, ret))
+                return false;
+            flow = Flow::Return;
+            return true;
+        default:
+            // 表达式语句
+            return eval(node, frame, value);
+    }
+}
+
+bool ConstEvaluator::eval_condition(ASTNodePtr node, Frame& frame,
+                                    bool& truth) {
+    if (node && node->node_type == NODE_BINARY_OP && node->name &&
+        (strcmp(node->name, "&&") == 0 || strcmp(node->name, "||") == 0)) {
+        if (node->child_count < 2 || !step() ||
+            !eval_condition(node->children[0], frame, truth))
+            return false;
+        if (truth == (strcmp(node->name, "||") == 0)) return true;
+        return eval_condition(node->children[1], frame, truth);
+    }
+    ConstValue value;
+    // 浮点数作条件时生成的IR先转换为int，与按非零判断不同，不作处理
+    if (!eval(node, frame, value) || value.is_float) return false;
+    truth = value.int_value != 0;
+    return true;
+}
+
+bool ConstEvaluator::eval(ASTNodePtr node, Frame& frame, ConstValue& value) {
+    if (!node || !step()) return false;
+    switch (node->node_type) {
+        case NODE_CONST:
+            if (node->data_type == NODEDATA_INT) {
+                value = make_int(node->data.direct_int);
+                return true;
+            }
+            if (node->data_type == NODEDATA_FLOAT) {
+                value = make_float(node->data.direct_float);
+                return true;
+            }
+            return false;
+        case NODE_VAR: {
+            // 全局变量与未赋值的局部变量都不在frame中
+            auto it = frame.find(node->data.symb_ptr);
+            if (it == frame.end()) return false;
+            value = it->second;
+            return true;
+        }
+        case NODE_CONST_ARRAY_ACCESS: {
+            SymbolPtr sym = node->data.symb_ptr;
+            if (!sym) return false;
+            ArrayInfo& info = sym->attributes.array_info;
+            if (!info.values.ints || !info.strides ||
+                node->child_count != info.dimensions)
+                return false;
+            int offset = 0;
+            for (int i = 0; i < node->child_count; i++) {
+                ConstValue index;
+                if (!eval(node->children[i], frame, index) || index.is_float ||
+                    index.int_value < 0 || index.int_value >= info.shape[i])
+                    return false;
+                offset += index.int_value * info.strides[i];
+            }
+            if (sym->data_type == DATA_FLOAT)
+                value = make_float(offset < info.value_count
+                                       ? info.values.floats[offset]
+                                       : 0);
+            else
+                value = make_int(
+                    offset < info.value_count ? info.values.ints[offset] : 0);
+            return true;
+        }
+        case NODE_FUNC_CALL: {
+            std::vector<ConstValue> args(node->child_count);
+            for (int i = 0; i < node->child_count; i++)
+                if (!eval(node->children[i], frame, args[i])) return false;
+            return call(node->data.symb_ptr, args, value);
+        }
+        case NODE_UNARY_OP: {
+            if (node->child_count < 1 ||
+                !eval(node->children[0], frame, value))
+                return false;
+            if (strcmp(node->name, "+") == 0) return true;
+            if (strcmp(node->name, "-") == 0) {
+                if (value.is_float)
+                    value.float_value = -value.float_value;
+                else
+                    value.int_value = (int)(0u - (unsigned)value.int_value);
+                return true;
+            }
+            // 生成的IR对浮点数取!时与0整数比较，不作处理
+            if (strcmp(node->name, "!") == 0 && !value.is_float) {
+                value = make_int(value.int_value == 0);
+                return true;
+            }
+            return false;
+        }
+        case NODE_BINARY_OP:
+            return eval_binary(node, frame, value);
+        default:
+            return false;
+    }
+}
+
+bool ConstEvaluator::eval_binary(ASTNodePtr node, Frame& frame,
+                                 ConstValue& value) {
+    if (node->child_count < 2) return false;
+    const char* op = node->name;
+    if (strcmp(op, "&&") == 0 || strcmp(op, "||") == 0) {
+        bool truth;
+        if (!eval_condition(node, frame, truth)) return false;
+        value = make_int(truth);
+        return true;
+    }
+
+    // i1再参与运算时的转换与按0/1计算不一定相同，不作处理
+    if (is_bool_exp(node->children[0]) || is_bool_exp(node->children[1]))
+        return false;
+
+    ConstValue lhs, rhs;
+    if (!eval(node->children[0], frame, lhs) ||
+        !eval(node->children[1], frame, rhs))
+        return false;
+
+    if (lhs.is_float || rhs.is_float) {
+        convert(lhs, DATA_FLOAT);
+        convert(rhs, DATA_FLOAT);
+        float l = lhs.float_value, r = rhs.float_value;
+        if (strcmp(op, "+") == 0) {
+            value = make_float(l + r);
+        } else if (strcmp(op, "-") == 0) {
+            value = make_float(l - r);
+        } else if (strcmp(op, "*") == 0) {
+            value = make_float(l * r);
+        } else if (strcmp(op, "/") == 0) {
+            value = make_float(l / r);
+        } else if (strcmp(op, "<") == 0) {
+            value = make_int(l < r);
+        } else if (strcmp(op, ">") == 0) {
+            value = make_int(l > r);
+        } else if (strcmp(op, "<=") == 0) {
+            value = make_int(l <= r);
+        } else if (strcmp(op, ">=") == 0) {
+            value = make_int(l >= r);
+        } else if (strcmp(op, "==") == 0) {
+            value = make_int(l == r);
+        } else if (strcmp(op, "!=") == 0) {
+            value = make_int(l != r);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // 整数运算按补码回绕；除零与INT_MIN / -1为未定义行为
+    int l = lhs.int_value, r = rhs.int_value;
+    if (strcmp(op, "+") == 0) {
+        value = make_int((int)((unsigned)l + (unsigned)r));
+    } else if (strcmp(op, "-") == 0) {
+        value = make_int((int)((unsigned)l - (unsigned)r));
+    } else if (strcmp(op, "*") == 0) {
+        value = make_int((int)((unsigned)l * (unsigned)r));
+    } else if (strcmp(op, "/") == 0 || strcmp(op, "%") == 0) {
+        if (r == 0 || (l == INT_MIN && r == -1)) return false;
+        value = make_int(op[0] == '/' ? l / r : l % r);
+    } else if (strcmp(op, "<") == 0) {
+        value = make_int(l < r);
+    } else if (strcmp(op, ">") == 0) {
+        value = make_int(l > r);
+    } else if (strcmp(op, "<=") == 0) {
+        value = make_int(l <= r);
+    } else if (strcmp(op, ">=") == 0) {
+        value = make_int(l >= r);
+    } else if (strcmp(op, "==") == 0) {
+        value = make_int(l == r);
+    } else if (strcmp(op, "!=") == 0) {
+        value = make_int(l != r);
+    } else {
+        return false;
+    }
+    return true;
+}
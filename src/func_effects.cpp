@@ -0,0 +1,281 @@
+#include "func_effects.h"
+
+#include <cstring>
+
+namespace {
+
+// 数组实参所指的对象
+struct ArgBase {
+    enum Kind { None, Local, Global, Param };
+    Kind kind = None;
+    // Local、Global时为数组（全局时也可能是标量），Param时为数组形参
+    SymbolPtr symbol = nullptr;
+    int param = -1;
+};
+
+struct CallSite {
+    SymbolPtr callee;
+    // 按实参下标，标量实参为None
+    std::vector<ArgBase> args;
+};
+
+// 分析中的函数：函数体的效果与调用点
+struct FuncState {
+    FunctionEffects effects;
+    std::vector<CallSite> calls;
+};
+
+// 函数func中的符号所指的对象，标量形参与局部变量一样不影响调用者
+ArgBase base_of(SymbolPtr func, SymbolPtr symbol) {
+    ArgBase base;
+    base.symbol = symbol;
+    if (symbol->scope_level == GLOBAL_SCOPE_LEVEL) {
+        base.kind = ArgBase::Global;
+        return base;
+    }
+    base.kind = ArgBase::Local;
+    if (symbol->symbol_type != SYMB_ARRAY) return base;
+    FuncInfo& info = func->attributes.func_info;
+    for (int i = 0; i < info.param_count; i++)
+        if (info.params[i] == symbol) {
+            base.kind = ArgBase::Param;
+            base.param = i;
+        }
+    return base;
+}
+
+bool set_flag(bool& flag) {
+    if (flag) return false;
+    flag = true;
+    return true;
+}
+
+bool set_flag(std::vector<bool>& flags, int index) {
+    if (flags[index]) return false;
+    flags[index] = true;
+    return true;
+}
+
+// 记录对base所指对象的读或写，返回摘要是否变化
+bool record_access(FunctionEffects& effects, const ArgBase& base, bool write) {
+    switch (base.kind) {
+        case ArgBase::Global: {
+            bool& flag = write ? effects.writes_globals : effects.reads_globals;
+            bool changed = set_flag(flag);
+            if (write && effects.stored_globals.insert(base.symbol).second)
+                changed = true;
+            if ((base.symbol->symbol_type == SYMB_ARRAY ||
+                 base.symbol->symbol_type == SYMB_CONST_ARRAY) &&
+                effects.global_arrays.insert(base.symbol).second)
+                changed = true;
+            return changed;
+        }
+        case ArgBase::Param:
+            return set_flag(write ? effects.writes_param : effects.reads_param,
+                            base.param);
+        default:
+            return false;
+    }
+}
+
+void scan_body(ASTNodePtr node, SymbolPtr func, FuncState& state);
+
+// 调用点：数组实参记录所指对象，其余实参按表达式扫描
+void scan_call(ASTNodePtr node, SymbolPtr func, FuncState& state) {
+    CallSite site;
+    site.callee = node->data.symb_ptr;
+    FuncInfo& info = site.callee->attributes.func_info;
+    for (int i = 0; i < node->child_count; i++) {
+        ASTNodePtr arg = node->children[i];
+        bool array_param = i < info.param_count &&
+                           info.params[i]->symbol_type == SYMB_ARRAY;
+        if (array_param && arg->data_type == NODEDATA_SYMB &&
+            arg->data.symb_ptr) {
+            site.args.push_back(base_of(func, arg->data.symb_ptr));
+            // 部分下标
+            for (int j = 0; j < arg->child_count; j++)
+                scan_body(arg->children[j], func, state);
+        } else {
+            site.args.push_back(ArgBase());
+            scan_body(arg, func, state);
+        }
+    }
+
+    std::vector<SymbolPtr>& callees = state.effects.callees;
+    bool known = false;
+    for (SymbolPtr callee : callees)
+        if (callee == site.callee) known = true;
+    if (!known) callees.push_back(site.callee);
+    state.calls.push_back(site);
+}
+
+// 收集函数体直接的读写与调用点。全局常量与常量数组的元素不计入
+void scan_body(ASTNodePtr node, SymbolPtr func, FuncState& state) {
+    if (!node) return;
+    SymbolPtr sym =
+        node->data_type == NODEDATA_SYMB ? node->data.symb_ptr : nullptr;
+    switch (node->node_type) {
+        case NODE_ASSIGN_STMT: {
+            if (node->child_count < 2) return;
+            ASTNodePtr left = node->children[0];
+            if (left->data_type == NODEDATA_SYMB && left->data.symb_ptr)
+                record_access(state.effects,
+                              base_of(func, left->data.symb_ptr), true);
+            for (int i = 0; i < left->child_count; i++)
+                scan_body(left->children[i], func, state);
+            scan_body(node->children[1], func, state);
+            return;
+        }
+        case NODE_VAR:
+        case NODE_ARRAY_ACCESS:
+            if (sym) record_access(state.effects, base_of(func, sym), false);
+            break;
+        case NODE_FUNC_CALL:
+            if (sym) {
+                scan_call(node, func, state);
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    for (int i = 0; i < node->child_count; i++)
+        scan_body(node->children[i], func, state);
+}
+
+// 调用点中数组实参所指的对象在调用期间可能经由其它途径访问：
+// 来自调用者中不是noalias的形参
+bool unknown_base(const ArgBase& base, const FunctionEffects& caller) {
+    return base.kind == ArgBase::Param && !caller.noalias_param[base.param];
+}
+
+// 调用点的第index个实参可能与其它数组实参或被调函数访问的全局数组重叠
+bool arg_may_alias(const CallSite& site, size_t index,
+                   const FunctionEffects& caller,
+                   const FunctionEffects& callee) {
+    const ArgBase& base = site.args[index];
+    if (unknown_base(base, caller)) return true;
+    if (base.kind == ArgBase::Global && callee.global_arrays.count(base.symbol))
+        return true;
+    for (size_t i = 0; i < site.args.size(); i++) {
+        const ArgBase& other = site.args[i];
+        if (i == index || other.kind == ArgBase::None) continue;
+        if (unknown_base(other, caller)) return true;
+        if (other.kind == base.kind && other.symbol == base.symbol) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+EffectMap analyze_effects(ASTNodePtr program) {
+    std::unordered_map<SymbolPtr, FuncState> states;
+    // 按定义顺序遍历，结果与哈希表的顺序无关
+    std::vector<SymbolPtr> order;
+    for (int i = 0; program && i < program->child_count; i++) {
+        ASTNodePtr child = program->children[i];
+        if (child->node_type != NODE_FUNC_DEF ||
+            child->data_type != NODEDATA_SYMB || !child->data.symb_ptr)
+            continue;
+        SymbolPtr func = child->data.symb_ptr;
+        FuncState& state = states[func];
+        int param_count = func->attributes.func_info.param_count;
+        state.effects.reads_param.assign(param_count, false);
+        state.effects.writes_param.assign(param_count, false);
+        state.effects.noalias_param.assign(param_count, false);
+        if (child->child_count > 1) scan_body(child->children[1], func, state);
+        order.push_back(func);
+    }
+
+    // 把被调函数的效果传递给调用者，数组形参的效果落到对应实参所指的对象上
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (SymbolPtr func : order) {
+            FunctionEffects& effects = states[func].effects;
+            for (const CallSite& site : states[func].calls) {
+                auto callee_it = states.find(site.callee);
+                if (callee_it == states.end()) {
+                    // 运行库函数都做输入输出，get开头的函数写数组实参
+                    changed |= set_flag(effects.does_io);
+                    bool writes = strncmp(site.callee->name, "get", 3) == 0;
+                    for (const ArgBase& base : site.args)
+                        changed |= record_access(effects, base, writes);
+                    continue;
+                }
+                // 递归调用时被调函数的摘要就是正在修改的摘要
+                FunctionEffects copy;
+                const FunctionEffects* callee = &callee_it->second.effects;
+                if (site.callee == func) {
+                    copy = *callee;
+                    callee = &copy;
+                }
+                if (callee->reads_globals)
+                    changed |= set_flag(effects.reads_globals);
+                if (callee->writes_globals)
+                    changed |= set_flag(effects.writes_globals);
+                if (callee->does_io) changed |= set_flag(effects.does_io);
+                for (SymbolPtr array : callee->global_arrays)
+                    changed |= effects.global_arrays.insert(array).second;
+                for (SymbolPtr global : callee->stored_globals)
+                    changed |= effects.stored_globals.insert(global).second;
+                for (size_t i = 0;
+                     i < site.args.size() && i < callee->reads_param.size();
+                     i++) {
+                    if (callee->reads_param[i])
+                        changed |= record_access(effects, site.args[i], false);
+                    if (callee->writes_param[i])
+                        changed |= record_access(effects, site.args[i], true);
+                }
+            }
+        }
+    }
+
+    // 从函数出发沿调用图能回到自身时是递归函数
+    for (SymbolPtr func : order) {
+        std::unordered_set<SymbolPtr> reached;
+        std::vector<SymbolPtr> pending = states[func].effects.callees;
+        while (!pending.empty()) {
+            SymbolPtr callee = pending.back();
+            pending.pop_back();
+            auto callee_it = states.find(callee);
+            if (callee_it == states.end() || !reached.insert(callee).second)
+                continue;
+            for (SymbolPtr next : callee_it->second.effects.callees)
+                pending.push_back(next);
+        }
+        states[func].effects.recursive = reached.count(func) > 0;
+    }
+
+    // 数组形参先假定为noalias，某个调用点的实参可能重叠时取消，直到不动点
+    for (SymbolPtr func : order) {
+        FuncInfo& info = func->attributes.func_info;
+        for (int i = 0; i < info.param_count; i++)
+            states[func].effects.noalias_param[i] =
+                info.params[i]->symbol_type == SYMB_ARRAY;
+    }
+    changed = true;
+    while (changed) {
+        changed = false;
+        for (SymbolPtr func : order) {
+            const FunctionEffects& caller = states[func].effects;
+            for (const CallSite& site : states[func].calls) {
+                auto callee_it = states.find(site.callee);
+                if (callee_it == states.end()) continue;
+                FunctionEffects& callee = callee_it->second.effects;
+                for (size_t i = 0;
+                     i < site.args.size() && i < callee.noalias_param.size();
+                     i++)
+                    if (callee.noalias_param[i] &&
+                        arg_may_alias(site, i, caller, callee)) {
+                        callee.noalias_param[i] = false;
+                        changed = true;
+                    }
+            }
+        }
+    }
+
+    EffectMap result;
+    for (SymbolPtr func : order) result[func] = states[func].effects;
+    return result;
+}
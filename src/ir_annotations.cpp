@@ -0,0 +1,89 @@
+#include "ir_annotations.h"
+
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+// 模块 -> (函数 -> 循环记录)
+std::unordered_map<const midend::Module*,
+                   std::unordered_map<const midend::Function*, FunctionLoops>>
+    loop_annotations;
+
+// 模块 -> (函数 -> 函数属性)
+std::unordered_map<
+    const midend::Module*,
+    std::unordered_map<const midend::Function*, FunctionAttributes>>
+    function_attributes;
+
+// 模块 -> (函数 -> 栈帧估计)
+std::unordered_map<const midend::Module*,
+                   std::unordered_map<const midend::Function*, StackEstimate>>
+    stack_estimates;
+
+// 模块 -> 裁剪的定义名
+std::unordered_map<const midend::Module*, std::vector<std::string>>
+    pruned_definitions;
+
+}  // namespace
+
+const FunctionLoops* get_loop_annotations(const midend::Module* module,
+                                          const midend::Function* func) {
+    auto module_it = loop_annotations.find(module);
+    if (module_it == loop_annotations.end()) return nullptr;
+    auto func_it = module_it->second.find(func);
+    if (func_it == module_it->second.end()) return nullptr;
+    return &func_it->second;
+}
+
+void set_loop_annotations(const midend::Module* module,
+                          const midend::Function* func, FunctionLoops loops) {
+    loop_annotations[module][func] = std::move(loops);
+}
+
+const FunctionAttributes* get_function_attributes(
+    const midend::Module* module, const midend::Function* func) {
+    auto module_it = function_attributes.find(module);
+    if (module_it == function_attributes.end()) return nullptr;
+    auto func_it = module_it->second.find(func);
+    if (func_it == module_it->second.end()) return nullptr;
+    return &func_it->second;
+}
+
+void set_function_attributes(const midend::Module* module,
+                             const midend::Function* func,
+                             FunctionAttributes attributes) {
+    function_attributes[module][func] = std::move(attributes);
+}
+
+const StackEstimate* get_stack_estimate(const midend::Module* module,
+                                        const midend::Function* func) {
+    auto module_it = stack_estimates.find(module);
+    if (module_it == stack_estimates.end()) return nullptr;
+    auto func_it = module_it->second.find(func);
+    if (func_it == module_it->second.end()) return nullptr;
+    return &func_it->second;
+}
+
+void set_stack_estimate(const midend::Module* module,
+                        const midend::Function* func, StackEstimate estimate) {
+    stack_estimates[module][func] = estimate;
+}
+
+const std::vector<std::string>* get_pruned_definitions(
+    const midend::Module* module) {
+    auto it = pruned_definitions.find(module);
+    return it == pruned_definitions.end() ? nullptr : &it->second;
+}
+
+void set_pruned_definitions(const midend::Module* module,
+                            std::vector<std::string> names) {
+    pruned_definitions[module] = std::move(names);
+}
+
+void clear_module_annotations(const midend::Module* module) {
+    loop_annotations.erase(module);
+    function_attributes.erase(module);
+    stack_estimates.erase(module);
+    pruned_definitions.erase(module);
+}
@@ -0,0 +1,124 @@
+#include "ir_cache.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+
+#include "IR/Module.h"
+#include "ir_serialize.h"
+
+namespace {
+
+// 缓存格式版本，前端生成的IR发生变化时递增使旧缓存失效
+const int kCacheVersion = 2;
+
+IRCacheStats cache_stats = {0, 0, 0, 0};
+
+// 64位FNV-1a
+uint64_t hash_fnv1a(const std::string& data, uint64_t hash) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// 与FNV独立的乘法哈希，两者拼接降低碰撞概率
+uint64_t hash_mul(const std::string& data, uint64_t hash) {
+    for (unsigned char c : data) {
+        hash = (hash + c) * 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+std::string cache_path(const std::string& cache_dir, const std::string& key) {
+    return cache_dir + "/" + key + ".sybc";
+}
+
+bool read_file(const std::string& path, std::string& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) out.append(buf, n);
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+}  // namespace
+
+std::string ir_cache_key(const std::string& source,
+                         const FrontendOptions& options) {
+    std::string option_bytes =
+        std::to_string(kCacheVersion) + frontend_options_key(options);
+
+    uint64_t h1 = hash_fnv1a(source, 0xcbf29ce484222325ULL);
+    h1 = hash_fnv1a(option_bytes, h1);
+    uint64_t h2 = hash_mul(source, source.size());
+    h2 = hash_mul(option_bytes, h2);
+
+    char key[64];
+    snprintf(key, sizeof(key), "%016llx%016llx-%llx", (unsigned long long)h1,
+             (unsigned long long)h2, (unsigned long long)source.size());
+    return key;
+}
+
+std::unique_ptr<midend::Module> ir_cache_load(const std::string& cache_dir,
+                                              const std::string& key) {
+    std::string data;
+    if (!read_file(cache_path(cache_dir, key), data)) {
+        cache_stats.misses++;
+        return nullptr;
+    }
+    auto module = read_module_binary(data.data(), data.size());
+    if (!module) {
+        // 缓存文件损坏或版本不符，按未命中处理
+        cache_stats.errors++;
+        cache_stats.misses++;
+        return nullptr;
+    }
+    cache_stats.hits++;
+    return module;
+}
+
+bool ir_cache_store(const std::string& cache_dir, const std::string& key,
+                    midend::Module* module) {
+    static unsigned tmp_counter = 0;
+    std::string data;
+    if (!write_module_binary(module, data)) {
+        cache_stats.errors++;
+        return false;
+    }
+
+    if (mkdir(cache_dir.c_str(), 0777) != 0 && errno != EEXIST) {
+        cache_stats.errors++;
+        return false;
+    }
+
+    // 临时文件名包含进程号，rename保证读者只会看到完整文件
+    std::string path = cache_path(cache_dir, key);
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid()) + "." +
+                           std::to_string(tmp_counter++);
+    FILE* file = fopen(tmp_path.c_str(), "wb");
+    if (!file) {
+        cache_stats.errors++;
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        remove(tmp_path.c_str());
+        cache_stats.errors++;
+        return false;
+    }
+    cache_stats.stores++;
+    return true;
+}
+
+const IRCacheStats& get_ir_cache_stats() { return cache_stats; }
+
+void reset_ir_cache_stats() { cache_stats = {0, 0, 0, 0}; }
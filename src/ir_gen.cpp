@@ -1,5 +1,8 @@
 #include "ir_gen.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <string>
@@ -25,14 +28,19 @@
 
 extern "C" {
 #include "sy_parser/AST.h"
+#include "sy_parser/ast_serialize.h"
+#include "sy_parser/parse.h"
 #include "sy_parser/symbol_table.h"
 #include "sy_parser/y.tab.h"
 
-extern int yyparse(void);
-extern FILE* yyin;
 extern ASTNodePtr root;
 }
 
+#include "const_eval.h"
+#include "func_effects.h"
+#include "ir_annotations.h"
+#include "ir_cache.h"
+#include "parallel_parse.h"
 #include "runtime_lib_def.h"
 
 // 全局标识符（函数、全局变量）
@@ -40,16 +48,18 @@ std::unordered_map<int, midend::Function*> func_tab;
 std::unordered_map<int, midend::GlobalVariable*> global_var_tab;
 std::unordered_set<int> function_param_symbols;
 
-// 控制流break、continue填充
-// 基本块及其所在基本块编号
-typedef struct {
-    midend::BasicBlock* block;
-    int block_idx;
-} BlockDepthPair;
-// 控制流break填充
-std::vector<BlockDepthPair> break_pos;
-// 控制流continue填充
-std::vector<BlockDepthPair> continue_pos;
+// 正在翻译的while循环，break、continue直接跳转到其中记录的目标
+struct LoopContext {
+    midend::Function* func;
+    // 循环的基本块编号
+    std::string block_id;
+    // break的目标（merge块），第一次break时创建
+    midend::BasicBlock* break_dest;
+    // continue的目标（cond块），旋转形式为latch块，第一次continue时创建
+    midend::BasicBlock* continue_dest;
+};
+// 内层循环在后
+std::vector<LoopContext> loop_stack;
 
 // IR变量编号
 int var_idx;
@@ -57,6 +67,107 @@ int var_idx;
 // IR基本块编号
 int block_idx;
 
+// 当前翻译使用的模块与前端选项
+midend::Module* ir_gen_module;
+FrontendOptions ir_gen_options;
+
+// 常量实参调用的编译期求值，未启用时为空
+std::unique_ptr<ConstEvaluator> const_evaluator;
+
+// 源程序中各函数的副作用摘要
+EffectMap func_effects;
+
+// 结果可以记忆化的函数，未启用时为空
+std::unordered_set<SymbolPtr> memo_funcs;
+
+// 翻译时跳过的函数与全局变量，未启用裁剪时为空
+std::unordered_set<SymbolPtr> pruned_symbols;
+
+// 从未写入的非常量全局变量与全局数组，未启用检测时为空
+std::unordered_set<SymbolPtr> readonly_globals;
+
+// 移到静态存储的局部数组，未启用时为空
+std::unordered_set<SymbolPtr> static_arrays;
+
+// 正在翻译的函数的栈帧估计
+StackEstimate stack_estimate;
+
+// 正在翻译的函数的符号，局部变量与形参的IR名称按相对它的编号
+SymbolPtr lowering_func_symbol = nullptr;
+
+// 各函数体用到的按需创建的模块实体（memset/memcpy声明、模板、静态数组、
+// 记忆化表）的名称，按第一次用到的顺序。实体在模块中的位置取决于第一个
+// 用到它的函数，增量编译据此判断模块布局是否不变
+std::unordered_map<midend::Function*, std::vector<std::string>>
+    func_lazy_entities;
+std::vector<std::string> lowering_lazy_entities;
+
+// 记录正在翻译的函数用到的按需创建的实体
+void note_lazy_entity(const std::string& name) {
+    if (std::find(lowering_lazy_entities.begin(), lowering_lazy_entities.end(),
+                  name) == lowering_lazy_entities.end())
+        lowering_lazy_entities.push_back(name);
+}
+
+// 正在翻译的记忆化函数：结果表、表项是否已填写，以及本次调用使用的表项
+struct MemoContext {
+    midend::GlobalVariable* values = nullptr;
+    midend::GlobalVariable* filled = nullptr;
+    midend::Type* table_type = nullptr;
+    midend::Value* slot = nullptr;
+};
+MemoContext memo_context;
+
+// 记忆化函数结果表的项数上限
+const int kMemoTableMax = 1 << 22;
+
+// 局部数组未覆盖区间少于该元素数时逐个存0，否则生成循环
+const int kZeroFillLoopMin = 8;
+
+// 直接构造SSA（Braun et al.）时当前函数的状态
+struct SSAPhi {
+    midend::PHINode* phi;
+    SymbolPtr symbol;
+    std::vector<midend::Value*> operands;
+};
+struct SSAState {
+    midend::Context* ctx;
+    // 以SSA值表示的标量局部变量（符号id）
+    std::unordered_set<int> vars;
+    // 符号id -> (基本块 -> 该块中变量的当前定义)
+    std::unordered_map<int, std::unordered_map<midend::BasicBlock*,
+                                               midend::Value*>>
+        current_def;
+    std::unordered_map<midend::BasicBlock*, std::vector<midend::BasicBlock*>>
+        preds;
+    std::unordered_set<midend::BasicBlock*> sealed;
+    // 未封闭基本块中尚未补全操作数的phi（phis中的下标）
+    std::unordered_map<midend::BasicBlock*, std::vector<int>> incomplete_phis;
+    std::vector<SSAPhi> phis;
+};
+// 非空时标量局部变量不再经过alloca/load/store
+SSAState* ssa_state = nullptr;
+
+// 当前函数中的循环，翻译完函数后整理为LoopAnnotation
+struct LoopRecord {
+    LoopAnnotation info;
+    // 进入循环前所在的基本块，及循环外跳转到header的块
+    midend::BasicBlock* preheader;
+    std::vector<midend::BasicBlock*> entries;
+    // 归纳变量的符号及其栈上的存储（直接构造SSA时为nullptr），不满足
+    // 条件时symbol为nullptr
+    SymbolPtr induction;
+    midend::Value* storage;
+    // 循环体中没有break、return，只能由条件退出
+    bool exits_only_by_cond;
+    // 进入循环时归纳变量的常量值
+    bool has_start;
+    int start;
+};
+std::vector<LoopRecord> loop_records;
+// 正在翻译的循环（loop_records中的下标），内层在后
+std::vector<int> open_loops;
+
 midend::Value* get_array_element_ptr(
     SymbolPtr symbol, const std::vector<midend::Value*>& indices,
     midend::IRBuilder& builder,
@@ -66,18 +177,30 @@ midend::Value* translate_node(
     ASTNodePtr node, midend::IRBuilder& builder, midend::Function* current_func,
     std::unordered_map<int, midend::Value*>& local_vars, DataType need_type);
 
-// 辅助函数：判断基本块是否在break或continue填充向量中
-bool in_break_continue_pos(midend::BasicBlock* block) {
-    for (auto pair : break_pos)
-        if (pair.block == block) return true;
-    for (auto pair : continue_pos)
-        if (pair.block == block) return true;
-    return false;
+// 辅助函数：当前循环break、continue的目标，尚未创建时创建
+midend::BasicBlock* loop_break_dest(midend::IRBuilder& builder) {
+    LoopContext& loop = loop_stack.back();
+    if (!loop.break_dest)
+        loop.break_dest = builder.createBasicBlock(
+            "while." + loop.block_id + ".merge", loop.func);
+    return loop.break_dest;
+}
+
+midend::BasicBlock* loop_continue_dest(midend::IRBuilder& builder) {
+    LoopContext& loop = loop_stack.back();
+    if (!loop.continue_dest)
+        loop.continue_dest = builder.createBasicBlock(
+            "while." + loop.block_id + ".latch", loop.func);
+    return loop.continue_dest;
 }
 
-// 获取变量在IR中的名称
+// 获取变量在IR中的名称。局部变量与形参的编号相对所在函数，函数体的IR
+// 不随前面的函数增删局部变量而变化
 std::string get_symbol_name(SymbolPtr symbol) {
-    return std::string(symbol->name) + "." + std::to_string(symbol->id);
+    int id = symbol->id;
+    if (symbol->scope_level != GLOBAL_SCOPE_LEVEL && lowering_func_symbol)
+        id -= lowering_func_symbol->id;
+    return std::string(symbol->name) + "." + std::to_string(id);
 }
 
 // 辅助函数：将DataType转换为IR类型
@@ -208,6 +331,163 @@ midend::Value* create_type_tran(midend::IRBuilder& builder,
     }
 }
 
+// 辅助函数：变量类型的0值，用作未定义变量的值
+midend::Constant* get_zero_value(midend::Context* ctx, DataType data_type) {
+    if (data_type == DATA_FLOAT)
+        return midend::ConstantFP::get(ctx->getFloatType(), 0.0f);
+    return midend::ConstantInt::get(
+        static_cast<midend::IntegerType*>(get_ir_type(ctx, data_type)), 0);
+}
+
+// 辅助函数：判断符号是否以SSA值表示
+bool is_ssa_var(SymbolPtr symbol) {
+    return ssa_state && symbol && ssa_state->vars.count(symbol->id);
+}
+
+// 启用省略时，没有引用的局部变量、局部数组与内部链接的全局变量不生成定义。
+// 外部链接的全局变量总是保留
+bool is_elided(SymbolPtr symbol) {
+    if (!ir_gen_options.elide_unused || symbol->ref_count > 0) return false;
+    if (symbol->scope_level != GLOBAL_SCOPE_LEVEL) return true;
+    return symbol->symbol_type == SYMB_CONST_VAR ||
+           symbol->symbol_type == SYMB_CONST_ARRAY ||
+           readonly_globals.count(symbol) > 0;
+}
+
+// 辅助函数：表达式中是否有函数调用
+bool has_func_call(ASTNodePtr node) {
+    if (!node) return false;
+    if (node->node_type == NODE_FUNC_CALL) return true;
+    for (int i = 0; i < node->child_count; i++)
+        if (has_func_call(node->children[i])) return true;
+    return false;
+}
+
+// 辅助函数：生成跳转指令，直接构造SSA时记录前驱
+void create_br(midend::IRBuilder& builder, midend::BasicBlock* dest) {
+    if (ssa_state) ssa_state->preds[dest].push_back(builder.getInsertBlock());
+    builder.createBr(dest);
+}
+
+void create_cond_br(midend::IRBuilder& builder, midend::Value* cond,
+                    midend::BasicBlock* then_dest,
+                    midend::BasicBlock* else_dest) {
+    if (ssa_state) {
+        ssa_state->preds[then_dest].push_back(builder.getInsertBlock());
+        ssa_state->preds[else_dest].push_back(builder.getInsertBlock());
+    }
+    builder.createCondBr(cond, then_dest, else_dest);
+}
+
+void ssa_write_variable(SymbolPtr symbol, midend::BasicBlock* block,
+                        midend::Value* value) {
+    ssa_state->current_def[symbol->id][block] = value;
+}
+
+midend::Value* ssa_read_variable(SymbolPtr symbol, midend::BasicBlock* block);
+
+// 在基本块开头创建变量的phi，返回其在phis中的下标
+int ssa_new_phi(SymbolPtr symbol, midend::BasicBlock* block) {
+    midend::PHINode* phi = midend::PHINode::Create(
+        get_ir_type(ssa_state->ctx, symbol->data_type),
+        get_symbol_name(symbol) + ".phi." + std::to_string(var_idx++));
+    block->push_front(phi);
+    ssa_state->phis.push_back({phi, symbol, {}});
+    return ssa_state->phis.size() - 1;
+}
+
+// 由各前驱中的定义补全phi的操作数
+void ssa_add_phi_operands(int phi_index) {
+    midend::PHINode* phi = ssa_state->phis[phi_index].phi;
+    SymbolPtr symbol = ssa_state->phis[phi_index].symbol;
+    // 递归读取可能创建新phi，因此不持有phis中元素的引用
+    std::vector<midend::BasicBlock*> preds =
+        ssa_state->preds[phi->getParent()];
+    for (midend::BasicBlock* pred : preds) {
+        midend::Value* value = ssa_read_variable(symbol, pred);
+        phi->addIncoming(value, pred);
+        ssa_state->phis[phi_index].operands.push_back(value);
+    }
+}
+
+midend::Value* ssa_read_variable(SymbolPtr symbol, midend::BasicBlock* block) {
+    auto& defs = ssa_state->current_def[symbol->id];
+    auto it = defs.find(block);
+    if (it != defs.end()) return it->second;
+
+    midend::Value* value;
+    const auto& preds = ssa_state->preds[block];
+    if (!ssa_state->sealed.count(block)) {
+        // 前驱尚未确定，先放置不完整的phi，封闭时补全
+        int phi_index = ssa_new_phi(symbol, block);
+        ssa_state->incomplete_phis[block].push_back(phi_index);
+        value = ssa_state->phis[phi_index].phi;
+    } else if (preds.size() == 1) {
+        value = ssa_read_variable(symbol, preds[0]);
+    } else if (preds.empty()) {
+        value = get_zero_value(ssa_state->ctx, symbol->data_type);
+    } else {
+        // 先记录phi以打断循环中的递归
+        int phi_index = ssa_new_phi(symbol, block);
+        value = ssa_state->phis[phi_index].phi;
+        ssa_write_variable(symbol, block, value);
+        ssa_add_phi_operands(phi_index);
+    }
+    ssa_write_variable(symbol, block, value);
+    return value;
+}
+
+// 基本块的所有前驱都已生成跳转，补全其中不完整的phi
+void ssa_seal_block(midend::BasicBlock* block) {
+    if (!ssa_state || !block || ssa_state->sealed.count(block)) return;
+    ssa_state->sealed.insert(block);
+    std::vector<int> incomplete = ssa_state->incomplete_phis[block];
+    ssa_state->incomplete_phis.erase(block);
+    for (int phi_index : incomplete) ssa_add_phi_operands(phi_index);
+}
+
+// 删除所有平凡phi（操作数除自身外只有一个不同的值），直到不动点
+void ssa_remove_trivial_phis() {
+    std::vector<SSAPhi>& phis = ssa_state->phis;
+    std::vector<bool> removed(phis.size(), false);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < phis.size(); ++i) {
+            if (removed[i]) continue;
+            midend::Value* same = nullptr;
+            bool trivial = true;
+            for (midend::Value* op : phis[i].operands) {
+                if (op == same || op == phis[i].phi) continue;
+                if (same) {
+                    trivial = false;
+                    break;
+                }
+                same = op;
+            }
+            if (!trivial) continue;
+            if (!same)
+                same = get_zero_value(ssa_state->ctx,
+                                      phis[i].symbol->data_type);
+            phis[i].phi->replaceAllUsesWith(same);
+            for (SSAPhi& other : phis)
+                for (midend::Value*& op : other.operands)
+                    if (op == phis[i].phi) op = same;
+            removed[i] = true;
+            changed = true;
+        }
+    }
+    // 被删除的phi之间可能互相引用，先断开全部操作数再删除
+    for (size_t i = 0; i < phis.size(); ++i)
+        if (removed[i]) phis[i].phi->dropAllReferences();
+    for (size_t i = 0; i < phis.size(); ++i)
+        if (removed[i]) phis[i].phi->eraseFromParent();
+    size_t kept = 0;
+    for (size_t i = 0; i < phis.size(); ++i)
+        if (!removed[i]) phis[kept++] = phis[i];
+    phis.resize(kept);
+}
+
 // 辅助函数：创建数组类型
 midend::Type* get_array_type(midend::Context* ctx, DataType base_type,
                              int dimensions, int* shape) {
@@ -240,52 +520,132 @@ std::vector<int> flat_to_multi_index(int flat_index,
     return indices;
 }
 
-// 辅助函数：处理数组初始化列表
-midend::Constant* process_array_init_list(midend::Context* ctx,
-                                          ASTNodePtr init_list,
-                                          midend::Type* target_type,
-                                          DataType base_type) {
-    if (!init_list || !target_type || !target_type->isArrayType())
-        return nullptr;
+// 辅助函数：判断常量是否为0（整数0、+0.0或空常量数组）
+bool is_zero_constant(midend::Constant* constant) {
+    if (auto const_int = dynamic_cast<midend::ConstantInt*>(constant))
+        return const_int->getValue() == 0;
+    if (auto const_fp = dynamic_cast<midend::ConstantFP*>(constant)) {
+        float value = const_fp->getValue();
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits == 0;
+    }
+    if (auto const_array = dynamic_cast<midend::ConstantArray*>(constant))
+        return const_array->getNumOperands() == 0;
+    return false;
+}
+
+// 辅助函数：去掉常量数组末尾的0，未列出的元素默认为0
+void trim_trailing_zeros(std::vector<midend::Constant*>& elements) {
+    while (!elements.empty() && is_zero_constant(elements.back()))
+        elements.pop_back();
+}
+
+// 辅助函数：递归构建全局数组初值。
+// 全为0的子数组化为空常量数组（zeroinitializer），末尾的0省略
+midend::Constant* build_array_init_constant(midend::Context* ctx,
+                                            ASTNodePtr list,
+                                            midend::Type* curr_type,
+                                            DataType base_type) {
+    if (!list || !curr_type) return nullptr;
 
-    // 如果初始化列表为空，创建一个空的常量数组
-    if (init_list->child_count == 0) {
-        if (target_type->isArrayType()) {
-            midend::ArrayType* array_type =
-                static_cast<midend::ArrayType*>(target_type);
-            std::vector<midend::Constant*> empty_elements;
-            return midend::ConstantArray::get(array_type, empty_elements);
+    if (!curr_type->isArrayType()) {
+        return get_global_type_value(ctx, list, base_type);
+    }
+
+    midend::ArrayType* array_type = static_cast<midend::ArrayType*>(curr_type);
+    midend::Type* elem_type = array_type->getElementType();
+    std::vector<midend::Constant*> elements;
+    elements.reserve(list->child_count);
+
+    for (int i = 0; i < list->child_count; ++i) {
+        ASTNodePtr child = list->children[i];
+        midend::Constant* elem =
+            build_array_init_constant(ctx, child, elem_type, base_type);
+        if (elem) {
+            elements.push_back(elem);
         }
-        return nullptr;
     }
+    trim_trailing_zeros(elements);
 
-    std::function<midend::Constant*(ASTNodePtr, midend::Type*)>
-        process_init_sparse =
-            [&](ASTNodePtr list, midend::Type* curr_type) -> midend::Constant* {
-        if (!list || !curr_type) return nullptr;
+    // 创建常量数组（即使为空）
+    return midend::ConstantArray::get(array_type, elements);
+}
 
-        if (!curr_type->isArrayType()) {
-            return get_global_type_value(ctx, list, base_type);
-        }
+// 辅助函数：从紧凑初始化器的扁平缓冲区中构建offset处开始的常量，
+// 缓冲区之外的部分全为0，直接省略
+midend::Constant* build_packed_init_constant(midend::Context* ctx,
+                                             PackedInitPtr packed,
+                                             midend::Type* curr_type,
+                                             int offset) {
+    if (!curr_type->isArrayType()) {
+        bool in_range = offset < packed->length;
+        if (curr_type->isFloatType())
+            return midend::ConstantFP::get(
+                ctx->getFloatType(),
+                in_range ? packed->values.floats[offset] : 0.0f);
+        return midend::ConstantInt::get(
+            ctx->getInt32Type(), in_range ? packed->values.ints[offset] : 0);
+    }
 
-        midend::ArrayType* array_type =
-            static_cast<midend::ArrayType*>(curr_type);
-        midend::Type* elem_type = array_type->getElementType();
-        std::vector<midend::Constant*> elements;
+    midend::ArrayType* array_type = static_cast<midend::ArrayType*>(curr_type);
+    midend::Type* elem_type = array_type->getElementType();
+    std::vector<int> dims;
+    get_array_dimensions(elem_type, dims);
+    int stride = 1;
+    for (int dim : dims) stride *= dim;
+
+    std::vector<midend::Constant*> elements;
+    int num = array_type->getNumElements();
+    for (int i = 0; i < num && offset + i * stride < packed->length; ++i)
+        elements.push_back(build_packed_init_constant(
+            ctx, packed, elem_type, offset + i * stride));
+    trim_trailing_zeros(elements);
+    return midend::ConstantArray::get(array_type, elements);
+}
 
-        for (int i = 0; i < list->child_count; ++i) {
-            ASTNodePtr child = list->children[i];
-            midend::Constant* elem = process_init_sparse(child, elem_type);
-            if (elem) {
-                elements.push_back(elem);
-            }
-        }
+// 辅助函数：从按行优先排列的元素常量中构建offset处开始的常量，
+// 空位与elements之外的部分为0
+midend::Constant* build_flat_init_constant(
+    midend::Context* ctx, const std::vector<midend::Constant*>& elements,
+    midend::Type* curr_type, DataType base_type, int offset) {
+    if (!curr_type->isArrayType()) {
+        if (offset < (int)elements.size() && elements[offset])
+            return elements[offset];
+        return get_zero_value(ctx, base_type);
+    }
 
-        // 创建常量数组（即使为空）
-        return midend::ConstantArray::get(array_type, elements);
-    };
+    midend::ArrayType* array_type = static_cast<midend::ArrayType*>(curr_type);
+    midend::Type* elem_type = array_type->getElementType();
+    std::vector<int> dims;
+    get_array_dimensions(elem_type, dims);
+    int stride = 1;
+    for (int dim : dims) stride *= dim;
+
+    std::vector<midend::Constant*> result;
+    int num = array_type->getNumElements();
+    for (int i = 0; i < num && offset + i * stride < (int)elements.size(); ++i)
+        result.push_back(build_flat_init_constant(ctx, elements, elem_type,
+                                                  base_type,
+                                                  offset + i * stride));
+    trim_trailing_zeros(result);
+    return midend::ConstantArray::get(array_type, result);
+}
 
-    return process_init_sparse(init_list, target_type);
+// 辅助函数：处理数组初始化列表
+midend::Constant* process_array_init_list(midend::Context* ctx,
+                                          ASTNodePtr init_list,
+                                          midend::Type* target_type,
+                                          DataType base_type) {
+    if (!init_list || !target_type || !target_type->isArrayType())
+        return nullptr;
+
+    // 紧凑初始化器中的非常量元素不能作为全局初值，与嵌套列表一样忽略
+    if (init_list->node_type == NODE_PACKED_INIT)
+        return build_packed_init_constant(ctx, init_list->data.packed,
+                                          target_type, 0);
+
+    return build_array_init_constant(ctx, init_list, target_type, base_type);
 }
 
 // 辅助函数：处理局部数组初始化的递归函数
@@ -353,35 +713,59 @@ void process_local_array_init_recursive(
     }
 }
 
-// 辅助函数：初始化数组元素
-void initialize_array_elements(
-    ASTNodePtr init_list, SymbolPtr symbol, midend::Value* array_alloca,
-    midend::IRBuilder& builder, midend::Function* current_func,
-    std::unordered_map<int, midend::Value*>& local_vars) {
-    if (array_alloca == nullptr) return;
+// 辅助函数：处理紧凑初始化器，常量直接取自扁平缓冲区，
+// 其余元素按源码顺序逐个翻译
+void process_local_packed_init(
+    ASTNodePtr packed_init, SymbolPtr symbol, midend::IRBuilder& builder,
+    std::unordered_map<int, midend::Value*>& local_vars,
+    std::map<int, midend::Value*>& init_values) {
+    PackedInitPtr packed = packed_init->data.packed;
+    int elem_num = symbol->attributes.array_info.elem_num;
+    int length = std::min(packed->length, elem_num);
+
+    for (int pos = 0; pos < length; ++pos) {
+        // 只考虑不为0的常数
+        if (symbol->data_type == DATA_FLOAT) {
+            if (packed->values.floats[pos] != 0.0f)
+                init_values[pos] = builder.getFloat(packed->values.floats[pos]);
+        } else if (packed->values.ints[pos] != 0) {
+            init_values[pos] = builder.getInt32(packed->values.ints[pos]);
+        }
+    }
 
-    // 将多维数组解释为一维数组
-    int dim_len = symbol->attributes.array_info.elem_num;
-    int one_dim_array_shape[1] = {dim_len};
-    midend::Type* one_dim_array_type = get_array_type(
-        builder.getContext(), symbol->data_type, 1, one_dim_array_shape);
+    for (int i = 0; i < packed_init->child_count; ++i) {
+        int pos = packed->expr_offsets[i];
+        if (pos >= elem_num) continue;
+        midend::Value* init_val =
+            translate_node(packed_init->children[i], builder, nullptr,
+                           local_vars, symbol->data_type);
+        init_val = create_type_tran(builder, init_val, symbol->data_type);
+        if (init_val) init_values[pos] = init_val;
+    }
+}
 
+// 辅助函数：生成循环，将一维数组[begin, end)区间内的元素置0
+void emit_zero_fill_loop(SymbolPtr symbol, midend::Value* array_alloca,
+                         midend::Type* one_dim_array_type, int begin, int end,
+                         const std::string& var_name,
+                         midend::IRBuilder& builder,
+                         midend::Function* current_func) {
     // 循环上界
-    midend::Value* top_bound = builder.getInt32(dim_len);
+    midend::Value* top_bound = builder.getInt32(end);
     // 循环变量
     midend::Type* var_type = builder.getContext()->getInt32Type();
-    std::string var_name = get_symbol_name(symbol) + ".initer";
     midend::Instruction* i_alloca =
         midend::AllocaInst::Create(var_type, nullptr, var_name);
     current_func->getEntryBlock().push_front(i_alloca);
+    stack_estimate.frame_bytes += 4;
     // 初始化
     std::string current_block_id = std::to_string(block_idx++);
-    builder.createStore(builder.getInt32(0), i_alloca);
+    builder.createStore(builder.getInt32(begin), i_alloca);
 
     // cond基本块
     midend::BasicBlock* condBB =
         builder.createBasicBlock(var_name + ".while.cond", current_func);
-    builder.createBr(condBB);
+    create_br(builder, condBB);
 
     // loop基本块
     midend::BasicBlock* loopBB =
@@ -407,7 +791,7 @@ void initialize_array_elements(
     midend::Value* i_new_value = builder.createAdd(
         i_old_value, builder.getInt32(1), std::to_string(var_idx++));
     builder.createStore(i_new_value, i_alloca);
-    builder.createBr(condBB);
+    create_br(builder, condBB);
 
     // merge基本块
     midend::BasicBlock* mergeBB =
@@ -419,21 +803,146 @@ void initialize_array_elements(
         builder.createLoad(i_alloca, std::to_string(var_idx++));
     midend::Value* cond = builder.createICmpSLT(
         i_value, top_bound, "lt." + std::to_string(var_idx++));
-    builder.createCondBr(cond, loopBB, mergeBB);
+    create_cond_br(builder, cond, loopBB, mergeBB);
+    ssa_seal_block(condBB);
+    ssa_seal_block(loopBB);
+    ssa_seal_block(mergeBB);
 
     // 继续在merge块中插入代码
     builder.setInsertPoint(mergeBB);
+}
 
-    // 处理初始化列表
-    std::map<int, midend::Value*> init_values;
-    if (init_list) {
-        int current_pos = 0;
-        process_local_array_init_recursive(init_list, symbol, builder,
-                                           local_vars, init_values, current_pos,
-                                           0);
+// 辅助函数：C库函数长度参数使用的size_t类型（目标为64位平台）
+midend::IntegerType* get_size_type(midend::Context* ctx) {
+    return ctx->getInt64Type();
+}
+
+// 辅助函数：获取C库函数memset/memcpy的声明，不存在时创建
+// 与libc的原型一致（返回dest，长度为size_t），指针统一按i32*传递：
+//   i32* memset(i32* dest, i32 value, i64 size)
+//   i32* memcpy(i32* dest, i32* src, i64 size)
+midend::Function* get_mem_func(midend::Context* ctx, const std::string& name) {
+    note_lazy_entity(name);
+    midend::Function* func = ir_gen_module->getFunction(name);
+    if (func) return func;
+    midend::Type* i32_ptr = midend::PointerType::get(ctx->getInt32Type());
+    std::vector<midend::Type*> param_types;
+    std::vector<std::string> param_names;
+    if (name == "memcpy") {
+        param_types = {i32_ptr, i32_ptr, get_size_type(ctx)};
+        param_names = {"dest", "src", "size"};
+    } else {
+        param_types = {i32_ptr, ctx->getInt32Type(), get_size_type(ctx)};
+        param_names = {"dest", "value", "size"};
     }
+    midend::FunctionType* func_type =
+        midend::FunctionType::get(i32_ptr, param_types);
+    return midend::Function::Create(func_type, name, param_names,
+                                    ir_gen_module);
+}
 
-    // 生成store指令，为每个元素赋值
+// 辅助函数：按i32一维数组取数组中第begin个元素的地址
+// （浮点数组按位重新解释，供memset/memcpy使用）
+midend::Value* get_i32_elem_ptr(midend::IRBuilder& builder, SymbolPtr symbol,
+                                midend::Value* array, int begin) {
+    int shape[1] = {symbol->attributes.array_info.elem_num};
+    midend::Type* int_array_type =
+        get_array_type(builder.getContext(), DATA_INT, 1, shape);
+    std::vector<midend::Value*> indices = {builder.getInt32(begin)};
+    return builder.createGEP(int_array_type, array, indices,
+                             std::to_string(var_idx++));
+}
+
+// 辅助函数：记忆化函数返回前把结果写入本次调用的表项
+void emit_memo_store(midend::IRBuilder& builder, midend::Value* value) {
+    std::vector<midend::Value*> indices = {memo_context.slot};
+    midend::Value* value_ptr =
+        builder.createGEP(memo_context.table_type, memo_context.values,
+                          indices, std::to_string(var_idx++));
+    builder.createStore(value, value_ptr);
+    midend::Value* filled_ptr =
+        builder.createGEP(memo_context.table_type, memo_context.filled,
+                          indices, std::to_string(var_idx++));
+    builder.createStore(builder.getInt32(1), filled_ptr);
+}
+
+// 辅助函数：统计初始化列表中的非0常量元素个数
+int count_const_init_elements(ASTNodePtr init_list) {
+    if (!init_list) return 0;
+    int count = 0;
+    if (init_list->node_type == NODE_PACKED_INIT) {
+        PackedInitPtr packed = init_list->data.packed;
+        for (int i = 0; i < packed->length; ++i)
+            if (packed->elem_type == DATA_FLOAT
+                    ? packed->values.floats[i] != 0.0f
+                    : packed->values.ints[i] != 0)
+                count++;
+        return count;
+    }
+    for (int i = 0; i < init_list->child_count; ++i) {
+        ASTNodePtr child = init_list->children[i];
+        if (!child) continue;
+        if (child->node_type == NODE_LIST) {
+            count += count_const_init_elements(child);
+        } else if (child->node_type == NODE_CONST) {
+            if ((child->data_type == NODEDATA_INT &&
+                 child->data.direct_int != 0) ||
+                (child->data_type == NODEDATA_FLOAT &&
+                 child->data.direct_float != 0.0f))
+                count++;
+        }
+    }
+    return count;
+}
+
+// 辅助函数：将一维数组[begin, end)区间内的元素置0
+void emit_zero_fill_range(SymbolPtr symbol, midend::Value* array_alloca,
+                          midend::Type* one_dim_array_type, int begin, int end,
+                          midend::IRBuilder& builder,
+                          midend::Function* current_func) {
+    auto ctx = builder.getContext();
+    int len = end - begin;
+
+    // 大区间调用memset，按i32重新解释数组（浮点0与整数0的位模式相同）
+    if (ir_gen_options.memset_threshold > 0 &&
+        ir_gen_options.enable_mangle_c_std_symbol &&
+        len >= ir_gen_options.memset_threshold) {
+        midend::Value* dest =
+            get_i32_elem_ptr(builder, symbol, array_alloca, begin);
+        midend::Value* size =
+            midend::ConstantInt::get(get_size_type(ctx), (int64_t)len * 4);
+        std::vector<midend::Value*> args = {dest, builder.getInt32(0), size};
+        builder.createCall(get_mem_func(ctx, "memset"), args,
+                           std::to_string(var_idx++));
+        return;
+    }
+
+    // 中等区间生成循环
+    if (len >= kZeroFillLoopMin) {
+        std::string var_name = get_symbol_name(symbol) + ".initer";
+        if (begin > 0) var_name += "." + std::to_string(begin);
+        emit_zero_fill_loop(symbol, array_alloca, one_dim_array_type, begin,
+                            end, var_name, builder, current_func);
+        return;
+    }
+
+    // 小区间逐个存0
+    midend::Value* fill_data = symbol->data_type == DATA_FLOAT
+                                   ? builder.getFloat(0.0)
+                                   : builder.getInt32(0);
+    for (int i = begin; i < end; i++) {
+        std::vector<midend::Value*> indices = {builder.getInt32(i)};
+        midend::Value* elem_ptr =
+            builder.createGEP(one_dim_array_type, array_alloca, indices,
+                              std::to_string(var_idx++));
+        builder.createStore(fill_data, elem_ptr);
+    }
+}
+
+// 辅助函数：按扁平下标存储数组初始化列表中的元素
+void emit_init_stores(const std::map<int, midend::Value*>& init_values,
+                      midend::Type* one_dim_array_type,
+                      midend::Value* array_ptr, midend::IRBuilder& builder) {
     for (auto p : init_values) {
         int flat_idx = p.first;
         midend::Value* init_value = p.second;
@@ -442,12 +951,169 @@ void initialize_array_elements(
         std::vector<midend::Value*> indices;
         indices.push_back(single_idx);
         midend::Value* elem_ptr =
-            builder.createGEP(one_dim_array_type, array_alloca, indices,
+            builder.createGEP(one_dim_array_type, array_ptr, indices,
                               std::to_string(var_idx++));
         builder.createStore(init_value, elem_ptr);
     }
 }
 
+// 辅助函数：取局部数组的只读模板并设置其内容，增量编译重新翻译函数时
+// 沿用模块中的同名模板
+midend::GlobalVariable* get_array_template(midend::Function* func,
+                                           SymbolPtr symbol,
+                                           midend::Type* type,
+                                           midend::Constant* init) {
+    std::string name =
+        func->getName() + "." + get_symbol_name(symbol) + ".template";
+    note_lazy_entity(name);
+    for (auto global : ir_gen_module->globals())
+        if (global->getName() == name) {
+            global->setInitializer(init);
+            return global;
+        }
+    return midend::GlobalVariable::Create(
+        type, true, midend::GlobalVariable::InternalLinkage, init, name,
+        ir_gen_module);
+}
+
+// 辅助函数：初始化数组元素
+void initialize_array_elements(
+    ASTNodePtr init_list, SymbolPtr symbol, midend::Value* array_alloca,
+    midend::IRBuilder& builder, midend::Function* current_func,
+    std::unordered_map<int, midend::Value*>& local_vars) {
+    if (array_alloca == nullptr) return;
+
+    // 将多维数组解释为一维数组
+    int dim_len = symbol->attributes.array_info.elem_num;
+    int one_dim_array_shape[1] = {dim_len};
+    midend::Type* one_dim_array_type = get_array_type(
+        builder.getContext(), symbol->data_type, 1, one_dim_array_shape);
+    bool by_coverage =
+        ir_gen_options.array_zero_fill == ArrayZeroFill::Coverage;
+    // 常量元素足够多时由只读全局模板整体复制，模板中已含0
+    bool by_template = ir_gen_options.array_template_min > 0 &&
+                       ir_gen_options.enable_mangle_c_std_symbol &&
+                       count_const_init_elements(init_list) >=
+                           ir_gen_options.array_template_min;
+
+    // 整个数组先置0
+    if (!by_coverage && !by_template) {
+        emit_zero_fill_loop(symbol, array_alloca, one_dim_array_type, 0,
+                            dim_len, get_symbol_name(symbol) + ".initer",
+                            builder, current_func);
+    }
+
+    // 处理初始化列表
+    std::map<int, midend::Value*> init_values;
+    if (init_list && init_list->node_type == NODE_PACKED_INIT) {
+        process_local_packed_init(init_list, symbol, builder, local_vars,
+                                  init_values);
+    } else if (init_list) {
+        int current_pos = 0;
+        process_local_array_init_recursive(init_list, symbol, builder,
+                                           local_vars, init_values, current_pos,
+                                           0);
+    }
+
+    if (by_template) {
+        // 常量部分放入模板，其余元素在复制后逐个存储
+        auto ctx = builder.getContext();
+        midend::Constant* zero =
+            symbol->data_type == DATA_FLOAT
+                ? (midend::Constant*)midend::ConstantFP::get(
+                      ctx->getFloatType(), 0.0f)
+                : (midend::Constant*)midend::ConstantInt::get(
+                      ctx->getInt32Type(), 0);
+        std::vector<midend::Constant*> elements(dim_len, zero);
+        for (auto it = init_values.begin(); it != init_values.end();) {
+            auto constant = dynamic_cast<midend::Constant*>(it->second);
+            if (constant) {
+                elements[it->first] = constant;
+                it = init_values.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        trim_trailing_zeros(elements);
+        midend::Constant* init = midend::ConstantArray::get(
+            static_cast<midend::ArrayType*>(one_dim_array_type), elements);
+        midend::GlobalVariable* tmpl = get_array_template(
+            current_func, symbol, one_dim_array_type, init);
+
+        midend::Value* dest =
+            get_i32_elem_ptr(builder, symbol, array_alloca, 0);
+        midend::Value* src = get_i32_elem_ptr(builder, symbol, tmpl, 0);
+        midend::Value* size =
+            midend::ConstantInt::get(get_size_type(ctx), (int64_t)dim_len * 4);
+        std::vector<midend::Value*> args = {dest, src, size};
+        builder.createCall(get_mem_func(ctx, "memcpy"), args,
+                           std::to_string(var_idx++));
+    }
+
+    // 只将初始化列表未覆盖（或显式为0）的区间置0
+    if (by_coverage && !by_template) {
+        int begin = 0;
+        for (auto p : init_values) {
+            if (p.first > begin)
+                emit_zero_fill_range(symbol, array_alloca, one_dim_array_type,
+                                     begin, p.first, builder, current_func);
+            begin = p.first + 1;
+        }
+        if (begin < dim_len)
+            emit_zero_fill_range(symbol, array_alloca, one_dim_array_type,
+                                 begin, dim_len, builder, current_func);
+    }
+
+    // 生成store指令，为每个元素赋值
+    emit_init_stores(init_values, one_dim_array_type, array_alloca, builder);
+}
+
+// 移到静态存储的局部数组的初始化，定义只执行一次：常量元素成为全局变量
+// 的初值，其余元素在定义处存储，未列出的元素由零初始化保证为0
+void initialize_static_array(
+    ASTNodePtr init_list, SymbolPtr symbol, midend::GlobalVariable* global,
+    midend::IRBuilder& builder,
+    std::unordered_map<int, midend::Value*>& local_vars) {
+    auto ctx = builder.getContext();
+    int dim_len = symbol->attributes.array_info.elem_num;
+    int one_dim_array_shape[1] = {dim_len};
+    midend::Type* one_dim_array_type =
+        get_array_type(ctx, symbol->data_type, 1, one_dim_array_shape);
+
+    std::map<int, midend::Value*> init_values;
+    if (init_list && init_list->node_type == NODE_PACKED_INIT) {
+        process_local_packed_init(init_list, symbol, builder, local_vars,
+                                  init_values);
+    } else if (init_list) {
+        int current_pos = 0;
+        process_local_array_init_recursive(init_list, symbol, builder,
+                                           local_vars, init_values, current_pos,
+                                           0);
+    }
+
+    // 非零常量按下标放入elements，末尾即最后一个非零常量
+    std::vector<midend::Constant*> elements;
+    for (auto it = init_values.begin(); it != init_values.end();) {
+        auto constant = dynamic_cast<midend::Constant*>(it->second);
+        if (!constant) {
+            ++it;
+            continue;
+        }
+        if (!is_zero_constant(constant)) {
+            elements.resize(it->first + 1, nullptr);
+            elements[it->first] = constant;
+        }
+        it = init_values.erase(it);
+    }
+    global->setInitializer(
+        elements.empty()
+            ? nullptr
+            : build_flat_init_constant(ctx, elements, global->getValueType(),
+                                       symbol->data_type, 0));
+
+    emit_init_stores(init_values, one_dim_array_type, global, builder);
+}
+
 midend::Value* create_binary_op(midend::IRBuilder& builder, midend::Value* left,
                                 midend::Value* right, std::string op_name) {
     // 检查操作数类型以决定生成整数还是浮点指令
@@ -542,6 +1208,50 @@ midend::Value* create_binary_op(midend::IRBuilder& builder, midend::Value* left,
         return nullptr;
 }
 
+// 辅助函数：按ArrayInfo中的步长将完整下标线性化为一个偏移，
+// 再以一维数组（形参为元素指针）的方式取元素地址
+midend::Value* get_flat_element_ptr(SymbolPtr symbol, midend::Value* array_ptr,
+                                    const std::vector<midend::Value*>& indices,
+                                    midend::IRBuilder& builder) {
+    const ArrayInfo& array_info = symbol->attributes.array_info;
+    bool fold = ir_gen_options.fold_array_offsets;
+    int const_offset = 0;
+    midend::Value* offset = nullptr;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        int stride = array_info.strides[i];
+        auto const_index = dynamic_cast<midend::ConstantInt*>(indices[i]);
+        if (fold && const_index) {
+            const_offset += (int)const_index->getSignedValue() * stride;
+            continue;
+        }
+        midend::Value* term = indices[i];
+        if (!fold || stride != 1)
+            term = builder.createMul(term, builder.getInt32(stride),
+                                     std::to_string(var_idx++));
+        offset = offset ? builder.createAdd(offset, term,
+                                            std::to_string(var_idx++))
+                        : term;
+    }
+    if (!offset)
+        offset = builder.getInt32(const_offset);
+    else if (const_offset)
+        offset = builder.createAdd(offset, builder.getInt32(const_offset),
+                                   std::to_string(var_idx++));
+
+    auto ctx = builder.getContext();
+    midend::Type* view_type;
+    if (function_param_symbols.count(symbol->id)) {
+        view_type =
+            midend::PointerType::get(get_ir_type(ctx, symbol->data_type));
+    } else {
+        int shape[1] = {array_info.elem_num};
+        view_type = get_array_type(ctx, symbol->data_type, 1, shape);
+    }
+    std::vector<midend::Value*> flat_index = {offset};
+    return builder.createGEP(view_type, array_ptr, flat_index,
+                             std::to_string(var_idx++));
+}
+
 // 辅助函数：获取数组元素指针
 midend::Value* get_array_element_ptr(
     SymbolPtr symbol, const std::vector<midend::Value*>& indices,
@@ -573,6 +1283,25 @@ midend::Value* get_array_element_ptr(
 
     if (!array_ptr || indices.empty()) return nullptr;
 
+    AddressLowering lowering = ir_gen_options.address_lowering;
+    const ArrayInfo& array_info = symbol->attributes.array_info;
+    bool full_access = array_info.strides &&
+                       (int)indices.size() == array_info.dimensions;
+    if (lowering == AddressLowering::MultiIndex &&
+        ir_gen_options.fold_array_offsets && full_access) {
+        bool all_const = true;
+        for (midend::Value* index : indices)
+            if (!dynamic_cast<midend::ConstantInt*>(index)) all_const = false;
+        if (all_const) lowering = AddressLowering::Flattened;
+    }
+
+    if (lowering == AddressLowering::Flattened && full_access)
+        return get_flat_element_ptr(symbol, array_ptr, indices, builder);
+
+    if (lowering != AddressLowering::PerDimension)
+        return builder.createGEP(array_type, array_ptr, indices,
+                                 std::to_string(var_idx++));
+
     for (midend::Value* single_indice : indices) {
         std::vector<midend::Value*> single_idx_vec;
         single_idx_vec.push_back(single_indice);
@@ -588,6 +1317,14 @@ midend::Value* get_array_element_ptr(
     return array_ptr;
 }
 
+// 辅助函数：局部变量或数组占用的字节数，元素都是4字节
+int64_t symbol_bytes(SymbolPtr symbol) {
+    if (symbol->symbol_type == SYMB_ARRAY ||
+        symbol->symbol_type == SYMB_CONST_ARRAY)
+        return 4 * (int64_t)symbol->attributes.array_info.elem_num;
+    return 4;
+}
+
 midend::Value* def_var(midend::IRBuilder& builder, SymbolPtr symbol,
                        std::unordered_map<int, midend::Value*>& local_vars) {
     SymbolType symb_type = symbol->symbol_type;
@@ -609,10 +1346,491 @@ midend::Value* def_var(midend::IRBuilder& builder, SymbolPtr symbol,
         if (type) alloca = builder.createAlloca(type, nullptr, name);
     }
 
-    if (alloca) local_vars[symbol->id] = alloca;
+    if (alloca) {
+        local_vars[symbol->id] = alloca;
+        int64_t bytes = symbol_bytes(symbol);
+        stack_estimate.frame_bytes += bytes;
+        if (symb_type == SYMB_ARRAY || symb_type == SYMB_CONST_ARRAY)
+            stack_estimate.largest_array_bytes =
+                std::max(stack_estimate.largest_array_bytes, bytes);
+    }
     return alloca;
 }
 
+// 移到静态存储的局部数组对应的内部全局变量，初值在定义处设置。
+// 增量编译重新翻译函数时沿用模块中的同名全局变量
+midend::GlobalVariable* get_static_array(midend::Context* ctx,
+                                         midend::Function* func,
+                                         SymbolPtr symbol) {
+    midend::Type* type = get_array_type(
+        ctx, symbol->data_type, symbol->attributes.array_info.dimensions,
+        symbol->attributes.array_info.shape);
+    std::string name =
+        func->getName() + "." + get_symbol_name(symbol) + ".static";
+    note_lazy_entity(name);
+    for (auto global : ir_gen_module->globals())
+        if (global->getName() == name) return global;
+    return midend::GlobalVariable::Create(
+        type, false, midend::GlobalVariable::InternalLinkage, nullptr, name,
+        ir_gen_module);
+}
+
+// 省略的变量定义：按原来的顺序求值初值中含函数调用的表达式，丢弃结果
+void translate_discarded_init(
+    ASTNodePtr init, SymbolPtr symbol, midend::IRBuilder& builder,
+    midend::Function* current_func,
+    std::unordered_map<int, midend::Value*>& local_vars) {
+    if (!init) return;
+    if (init->node_type == NODE_LIST || init->node_type == NODE_PACKED_INIT) {
+        for (int i = 0; i < init->child_count; i++)
+            translate_discarded_init(init->children[i], symbol, builder,
+                                     current_func, local_vars);
+        return;
+    }
+    if (has_func_call(init))
+        translate_node(init, builder, current_func, local_vars,
+                       symbol->data_type);
+}
+
+// 条件上下文中的跳转（回填法）：出口基本块创建后才生成跳转指令
+struct CondBranch {
+    midend::BasicBlock* block;
+    // 为空时是到dest[0]的无条件跳转
+    midend::Value* cond;
+    midend::BasicBlock* dest[2];
+};
+// 待回填的跳转目标：(branches中的下标, dest中的下标)
+typedef std::vector<std::pair<int, int>> CondList;
+
+// if/while的条件：普通翻译时为i1值，条件上下文中为待生成的跳转
+struct Condition {
+    midend::Value* value = nullptr;
+    std::vector<CondBranch> branches;
+    CondList true_list, false_list;
+    // 短路求值新建的右操作数基本块，生成跳转后封闭
+    std::vector<midend::BasicBlock*> rhs_blocks;
+};
+
+void backpatch(Condition& cond, const CondList& list,
+               midend::BasicBlock* dest) {
+    for (const auto& slot : list)
+        cond.branches[slot.first].dest[slot.second] = dest;
+}
+
+// 在条件上下文中翻译表达式：&&、||、!不再生成phi，直接跳转到真/假出口
+bool translate_cond_jumps(ASTNodePtr node, midend::IRBuilder& builder,
+                          midend::Function* current_func,
+                          std::unordered_map<int, midend::Value*>& local_vars,
+                          Condition& cond, CondList& true_list,
+                          CondList& false_list) {
+    std::string op_name = node->name ? node->name : "";
+    if (node->node_type == NODE_BINARY_OP && node->child_count >= 2 &&
+        (op_name == "&&" || op_name == "||")) {
+        std::string current_block_id = std::to_string(block_idx++);
+        bool is_and = op_name == "&&";
+        CondList left_true, left_false;
+        if (!translate_cond_jumps(node->children[0], builder, current_func,
+                                  local_vars, cond, left_true, left_false))
+            return false;
+
+        // &&：左边为真时计算右边；||：左边为假时计算右边。左边为常量、
+        // 不会进入右边时不翻译右边
+        CondList& rhs_list = is_and ? left_true : left_false;
+        if (rhs_list.empty()) {
+            CondList& exit_list = is_and ? false_list : true_list;
+            exit_list = is_and ? left_false : left_true;
+            return true;
+        }
+        midend::BasicBlock* rhsBB = builder.createBasicBlock(
+            (is_and ? "and." : "or.") + current_block_id + ".rhs",
+            current_func);
+        cond.rhs_blocks.push_back(rhsBB);
+        backpatch(cond, rhs_list, rhsBB);
+
+        builder.setInsertPoint(rhsBB);
+        if (!translate_cond_jumps(node->children[1], builder, current_func,
+                                  local_vars, cond, true_list, false_list))
+            return false;
+
+        // 短路的一侧直接跳到整个表达式的出口
+        CondList& short_list = is_and ? left_false : left_true;
+        CondList& exit_list = is_and ? false_list : true_list;
+        exit_list.insert(exit_list.end(), short_list.begin(),
+                         short_list.end());
+        return true;
+    }
+    if (node->node_type == NODE_UNARY_OP && node->child_count >= 1 &&
+        op_name == "!")
+        return translate_cond_jumps(node->children[0], builder, current_func,
+                                    local_vars, cond, false_list, true_list);
+
+    int branch_index = (int)cond.branches.size();
+    if (node->node_type == NODE_CONST) {
+        // 常量条件直接跳转
+        bool value = node->data_type == NODEDATA_FLOAT
+                         ? node->data.direct_float != 0
+                         : node->data.direct_int != 0;
+        cond.branches.push_back(
+            {builder.getInsertBlock(), nullptr, {nullptr, nullptr}});
+        (value ? true_list : false_list).push_back({branch_index, 0});
+        return true;
+    }
+
+    midend::Value* value = translate_node(node, builder, current_func,
+                                          local_vars, DATA_BOOL);
+    value = create_type_tran(builder, value, DATA_BOOL);
+    if (!value) return false;
+    cond.branches.push_back(
+        {builder.getInsertBlock(), value, {nullptr, nullptr}});
+    true_list.push_back({branch_index, 0});
+    false_list.push_back({branch_index, 1});
+    return true;
+}
+
+// 翻译if/while的条件
+bool translate_condition(ASTNodePtr node, midend::IRBuilder& builder,
+                         midend::Function* current_func,
+                         std::unordered_map<int, midend::Value*>& local_vars,
+                         Condition& cond) {
+    if (ir_gen_options.branch_conditions)
+        return translate_cond_jumps(node, builder, current_func, local_vars,
+                                    cond, cond.true_list, cond.false_list);
+    cond.value =
+        translate_node(node, builder, current_func, local_vars, DATA_BOOL);
+    cond.value = create_type_tran(builder, cond.value, DATA_BOOL);
+    return cond.value != nullptr;
+}
+
+// 条件能否为真/为假：条件上下文中看对应的回填列表是否为空。普通翻译
+// 时常量条件也生成两个方向的条件跳转（由中端折叠），总是返回true
+bool condition_may_be(const Condition& cond, bool outcome) {
+    if (cond.value) return true;
+    return !(outcome ? cond.true_list : cond.false_list).empty();
+}
+
+// 辅助函数：判断是否为非零整数常量
+bool is_true_constant(midend::Value* value) {
+    auto constant = dynamic_cast<midend::ConstantInt*>(value);
+    return constant && constant->getValue() != 0;
+}
+
+// 生成条件跳转，block_after_cond为计算完条件值的基本块。不可能到达的
+// 目标为nullptr；普通翻译时false_dest为nullptr则生成无条件跳转
+void emit_condition_br(midend::IRBuilder& builder, Condition& cond,
+                       midend::BasicBlock* block_after_cond,
+                       midend::BasicBlock* true_dest,
+                       midend::BasicBlock* false_dest) {
+    if (cond.value) {
+        builder.setInsertPoint(block_after_cond);
+        if (false_dest)
+            create_cond_br(builder, cond.value, true_dest, false_dest);
+        else
+            create_br(builder, true_dest);
+        return;
+    }
+    backpatch(cond, cond.true_list, true_dest);
+    backpatch(cond, cond.false_list, false_dest);
+    for (const CondBranch& branch : cond.branches) {
+        builder.setInsertPoint(branch.block);
+        if (branch.cond)
+            create_cond_br(builder, branch.cond, branch.dest[0],
+                           branch.dest[1]);
+        else
+            create_br(builder, branch.dest[0]);
+    }
+    for (midend::BasicBlock* block : cond.rhs_blocks) ssa_seal_block(block);
+}
+
+// 统计子树中对变量sym的赋值次数
+int count_assignments(ASTNodePtr node, SymbolPtr sym) {
+    if (!node) return 0;
+    int count = 0;
+    if (node->node_type == NODE_ASSIGN_STMT && node->child_count > 0 &&
+        node->children[0]->node_type == NODE_VAR &&
+        node->children[0]->data.symb_ptr == sym)
+        count++;
+    for (int i = 0; i < node->child_count; ++i)
+        count += count_assignments(node->children[i], sym);
+    return count;
+}
+
+// 判断子树中是否有type类型的跳转语句，enter_loops为false时不检查内层循环
+bool contains_jump(ASTNodePtr node, NodeType type, bool enter_loops) {
+    if (!node) return false;
+    if (node->node_type == type) return true;
+    if (node->node_type == NODE_WHILE_STMT && !enter_loops) return false;
+    for (int i = 0; i < node->child_count; ++i)
+        if (contains_jump(node->children[i], type, enter_loops)) return true;
+    return false;
+}
+
+// 判断语句是否为 sym = sym + 1 或 sym = 1 + sym
+bool is_unit_increment(ASTNodePtr node, SymbolPtr sym) {
+    if (node->node_type != NODE_ASSIGN_STMT || node->child_count < 2 ||
+        node->children[0]->node_type != NODE_VAR ||
+        node->children[0]->data.symb_ptr != sym)
+        return false;
+    ASTNodePtr value = node->children[1];
+    if (value->node_type != NODE_BINARY_OP || value->child_count < 2 ||
+        !value->name || strcmp(value->name, "+") != 0)
+        return false;
+    for (int i = 0; i < 2; ++i) {
+        ASTNodePtr var = value->children[i];
+        ASTNodePtr one = value->children[1 - i];
+        if (var->node_type == NODE_VAR && var->data.symb_ptr == sym &&
+            one->node_type == NODE_CONST && one->data_type == NODEDATA_INT &&
+            one->data.direct_int == 1)
+            return true;
+    }
+    return false;
+}
+
+// 判断循环体每次迭代是否无条件执行sym的自增（不在if、内层循环中）
+bool has_top_level_increment(ASTNodePtr node, SymbolPtr sym) {
+    if (!node) return false;
+    if (node->node_type != NODE_LIST) return is_unit_increment(node, sym);
+    for (int i = 0; i < node->child_count; ++i)
+        if (has_top_level_increment(node->children[i], sym)) return true;
+    return false;
+}
+
+// 开始记录一个while循环，在生成循环的任何基本块之前调用。条件为
+// i < 常量、i为局部整型标量且循环体中唯一的赋值是无条件的 i = i + 1
+// 时，记录i作为归纳变量
+int begin_loop_record(
+    ASTNodePtr node, midend::IRBuilder& builder,
+    const std::unordered_map<int, midend::Value*>& local_vars) {
+    LoopRecord record = {};
+    record.preheader = builder.getInsertBlock();
+    record.info.depth = open_loops.size() + 1;
+    record.info.parent = open_loops.empty() ? -1 : open_loops.back();
+
+    ASTNodePtr cond = node->children[0];
+    ASTNodePtr body = node->children[1];
+    SymbolPtr sym = nullptr;
+    if (cond->node_type == NODE_BINARY_OP && cond->child_count == 2 &&
+        cond->name && strcmp(cond->name, "<") == 0 &&
+        cond->children[0]->node_type == NODE_VAR &&
+        cond->children[1]->node_type == NODE_CONST &&
+        cond->children[1]->data_type == NODEDATA_INT)
+        sym = cond->children[0]->data.symb_ptr;
+    auto storage_it = sym ? local_vars.find(sym->id) : local_vars.end();
+    bool is_local = sym && (is_ssa_var(sym) || storage_it != local_vars.end());
+    if (is_local && sym->symbol_type == SYMB_VAR &&
+        sym->data_type == DATA_INT && count_assignments(body, sym) == 1 &&
+        has_top_level_increment(body, sym) &&
+        !contains_jump(body, NODE_CONTINUE_STMT, false)) {
+        record.induction = sym;
+        record.info.bound = cond->children[1]->data.direct_int;
+        record.exits_only_by_cond =
+            !contains_jump(body, NODE_BREAK_STMT, false) &&
+            !contains_jump(body, NODE_RETURN_STMT, true);
+        if (!is_ssa_var(sym)) {
+            // 进入循环前的基本块中最后一次存入i的值
+            record.storage = storage_it->second;
+            midend::Value* last = nullptr;
+            for (midend::Instruction* inst : *record.preheader) {
+                auto store = dynamic_cast<midend::StoreInst*>(inst);
+                if (store && store->getPointerOperand() == record.storage)
+                    last = store->getValueOperand();
+            }
+            if (auto start = dynamic_cast<midend::ConstantInt*>(last)) {
+                record.has_start = true;
+                record.start = (int)start->getSignedValue();
+            }
+        }
+    }
+
+    loop_records.push_back(record);
+    open_loops.push_back(loop_records.size() - 1);
+    return loop_records.size() - 1;
+}
+
+// 结束循环的记录，在生成全部跳转并封闭基本块之后调用。entries为循环外
+// 跳转到header的块，为空时只有preheader
+void end_loop_record(int loop, midend::BasicBlock* header,
+                     midend::BasicBlock* exit,
+                     std::vector<midend::BasicBlock*> entries) {
+    LoopRecord& record = loop_records[loop];
+    record.info.header = header;
+    record.info.exit = exit;
+    if (entries.empty()) entries.push_back(record.preheader);
+    record.entries = std::move(entries);
+    open_loops.pop_back();
+
+    // 此时header中的phi已从preheader读取过i，可直接查到其定义
+    if (record.induction && is_ssa_var(record.induction)) {
+        auto& defs = ssa_state->current_def[record.induction->id];
+        auto it = defs.find(record.preheader);
+        auto start = it == defs.end()
+                         ? nullptr
+                         : dynamic_cast<midend::ConstantInt*>(it->second);
+        if (start) {
+            record.has_start = true;
+            record.start = (int)start->getSignedValue();
+        }
+    }
+}
+
+// 函数翻译完成后，由循环记录补全基本块、latch与归纳变量并登记到模块。
+// header的前驱中除entries外都是latch，从latch沿前驱回溯到header得到
+// 循环的基本块。没有回边的循环（循环体总是跳出）不登记
+void finish_loop_records(midend::Module* module, midend::Function* func) {
+    std::vector<midend::BasicBlock*> order(func->begin(), func->end());
+    std::unordered_map<midend::BasicBlock*, size_t> position;
+    std::unordered_map<midend::BasicBlock*, std::vector<midend::BasicBlock*>>
+        preds;
+    for (size_t i = 0; i < order.size(); ++i) {
+        position[order[i]] = i;
+        auto br =
+            dynamic_cast<midend::BranchInst*>(order[i]->getTerminator());
+        if (!br) continue;
+        int succ_count = br->isConditional() ? 2 : 1;
+        for (int succ = 0; succ < succ_count; ++succ)
+            preds[br->getSuccessor(succ)].push_back(order[i]);
+    }
+    // 按在函数中的顺序排列一组基本块
+    auto in_order = [&](const std::unordered_set<midend::BasicBlock*>& set) {
+        std::vector<size_t> positions;
+        for (midend::BasicBlock* block : set)
+            positions.push_back(position[block]);
+        std::sort(positions.begin(), positions.end());
+        std::vector<midend::BasicBlock*> blocks;
+        for (size_t pos : positions) blocks.push_back(order[pos]);
+        return blocks;
+    };
+
+    FunctionLoops loops;
+    // loop_records中的下标 -> loops中的下标，未登记为-1
+    std::vector<int> index(loop_records.size(), -1);
+    for (size_t i = 0; i < loop_records.size(); ++i) {
+        LoopRecord& record = loop_records[i];
+        LoopAnnotation info = record.info;
+        std::unordered_set<midend::BasicBlock*> members = {info.header};
+        std::unordered_set<midend::BasicBlock*> entries(
+            record.entries.begin(), record.entries.end());
+        std::unordered_set<midend::BasicBlock*> latches;
+        std::vector<midend::BasicBlock*> work;
+        for (midend::BasicBlock* pred : preds[info.header]) {
+            if (entries.count(pred) || !latches.insert(pred).second) continue;
+            if (members.insert(pred).second) work.push_back(pred);
+        }
+        if (latches.empty()) continue;
+        while (!work.empty()) {
+            midend::BasicBlock* block = work.back();
+            work.pop_back();
+            for (midend::BasicBlock* pred : preds[block])
+                if (members.insert(pred).second) work.push_back(pred);
+        }
+        info.blocks = in_order(members);
+        info.latches = in_order(latches);
+
+        // 外层循环没有登记时取更外一层
+        int parent = info.parent;
+        while (parent >= 0 && index[parent] < 0)
+            parent = loop_records[parent].info.parent;
+        info.parent = parent >= 0 ? index[parent] : -1;
+        info.depth = parent >= 0 ? loops[info.parent].depth + 1 : 1;
+
+        if (record.induction) {
+            info.induction = record.storage;
+            if (ssa_state)
+                for (const SSAPhi& phi : ssa_state->phis)
+                    if (phi.symbol == record.induction &&
+                        phi.phi->getParent() == info.header)
+                        info.induction = phi.phi;
+        }
+        if (info.induction && record.exits_only_by_cond && record.has_start)
+            info.trip_count =
+                std::max<int64_t>(0, (int64_t)info.bound - record.start);
+        index[i] = loops.size();
+        loops.push_back(info);
+    }
+    set_loop_annotations(module, func, std::move(loops));
+}
+
+// 条件判断中生成跳转的基本块
+std::vector<midend::BasicBlock*> condition_blocks(
+    const Condition& cond, midend::BasicBlock* block_after_cond) {
+    if (cond.value) return {block_after_cond};
+    std::vector<midend::BasicBlock*> blocks;
+    for (const CondBranch& branch : cond.branches)
+        blocks.push_back(branch.block);
+    return blocks;
+}
+
+// 以旋转形式翻译while：入口处先判断一次条件（guard），循环体末尾
+// 再判断条件并跳回循环体，每次迭代省去一次无条件跳转。
+// 循环中有continue时，末尾的判断放在单独的latch块中作为continue的目标
+midend::Value* translate_rotated_while(
+    ASTNodePtr node, midend::IRBuilder& builder, midend::Function* current_func,
+    std::unordered_map<int, midend::Value*>& local_vars, DataType need_type) {
+    int loop = begin_loop_record(node, builder, local_vars);
+    std::string current_block_id = std::to_string(block_idx++);
+
+    // guard：在当前基本块中计算条件
+    Condition guard;
+    if (!translate_condition(node->children[0], builder, current_func,
+                             local_vars, guard))
+        return nullptr;
+    midend::BasicBlock* block_after_guard = builder.getInsertBlock();
+
+    // loop基本块，条件恒为假时不生成
+    midend::BasicBlock* loopBB = nullptr;
+    midend::BasicBlock* latchBB = nullptr;
+    Condition latch;
+    bool has_latch = false;
+    midend::BasicBlock* block_after_latch = nullptr;
+    loop_stack.push_back({current_func, current_block_id, nullptr, nullptr});
+    if (condition_may_be(guard, true)) {
+        loopBB = builder.createBasicBlock(
+            "while." + current_block_id + ".loop", current_func);
+        builder.setInsertPoint(loopBB);
+        translate_node(node->children[1], builder, current_func, local_vars,
+                       need_type);
+        bool body_falls_through = !builder.getInsertBlock()->getTerminator();
+
+        // latch：循环体末尾（或latch块）中再次计算条件
+        latchBB = loop_stack.back().continue_dest;
+        if (latchBB) {
+            if (body_falls_through) create_br(builder, latchBB);
+            builder.setInsertPoint(latchBB);
+        }
+        has_latch = latchBB || body_falls_through;
+        if (has_latch && !translate_condition(node->children[0], builder,
+                                              current_func, local_vars,
+                                              latch)) {
+            loop_stack.pop_back();
+            return nullptr;
+        }
+        block_after_latch = builder.getInsertBlock();
+    }
+
+    // merge基本块，条件恒为真且没有break时循环不会结束，不生成
+    bool exits = condition_may_be(guard, false) &&
+                 !is_true_constant(guard.value);
+    if (exits) loop_break_dest(builder);
+    midend::BasicBlock* mergeBB = loop_stack.back().break_dest;
+    loop_stack.pop_back();
+
+    // 跳转指令
+    midend::BasicBlock* exit_dest = exits ? mergeBB : nullptr;
+    emit_condition_br(builder, guard, block_after_guard, loopBB, exit_dest);
+    if (has_latch)
+        emit_condition_br(builder, latch, block_after_latch, loopBB,
+                          exit_dest);
+    ssa_seal_block(loopBB);
+    ssa_seal_block(latchBB);
+    ssa_seal_block(mergeBB);
+    end_loop_record(loop, loopBB, mergeBB,
+                    condition_blocks(guard, block_after_guard));
+
+    // 继续在merge块生成代码，没有merge块时之后的语句不可达
+    if (mergeBB) builder.setInsertPoint(mergeBB);
+
+    return nullptr;
+}
+
 // 递归处理AST节点的函数（处理函数内部的语句）
 midend::Value* translate_node(
     ASTNodePtr node, midend::IRBuilder& builder, midend::Function* current_func,
@@ -630,7 +1848,8 @@ midend::Value* translate_node(
                                    local_vars, need_type);
                 if (node->children[i]->node_type == NODE_BREAK_STMT ||
                     node->children[i]->node_type == NODE_CONTINUE_STMT ||
-                    node->children[i]->node_type == NODE_RETURN_STMT)
+                    node->children[i]->node_type == NODE_RETURN_STMT ||
+                    builder.getInsertBlock()->getTerminator())
                     break;
             }
             return last_value;
@@ -645,6 +1864,10 @@ midend::Value* translate_node(
             SymbolPtr symbol = node->data.symb_ptr;
             if (node->data_type != NODEDATA_SYMB && !symbol) return nullptr;
 
+            // SSA形式的局部变量，取当前基本块中的定义
+            if (is_ssa_var(symbol))
+                return ssa_read_variable(symbol, builder.getInsertBlock());
+
             // 从局部变量映射中查找
             auto it = local_vars.find(symbol->id);
             if (it != local_vars.end())
@@ -704,6 +1927,32 @@ midend::Value* translate_node(
             SymbolPtr func_sym = node->data.symb_ptr;
             if (node->data_type != NODEDATA_SYMB && !func_sym) return nullptr;
 
+            // 实参都是常量时尝试在编译期求值，失败则照常生成调用
+            if (const_evaluator) {
+                std::vector<ConstValue> args;
+                for (int i = 0; i < node->child_count; ++i) {
+                    ASTNodePtr arg = node->children[i];
+                    if (arg->node_type != NODE_CONST ||
+                        (arg->data_type != NODEDATA_INT &&
+                         arg->data_type != NODEDATA_FLOAT))
+                        break;
+                    ConstValue value;
+                    value.is_float = arg->data_type == NODEDATA_FLOAT;
+                    if (value.is_float)
+                        value.float_value = arg->data.direct_float;
+                    else
+                        value.int_value = arg->data.direct_int;
+                    args.push_back(value);
+                }
+                ConstValue result;
+                if ((int)args.size() == node->child_count &&
+                    const_evaluator->evaluate_call(func_sym, args, result))
+                    return result.is_float
+                               ? (midend::Value*)builder.getFloat(
+                                     result.float_value)
+                               : builder.getInt32(result.int_value);
+            }
+
             std::vector<midend::Value*> params;
             for (int i = 0; i < node->child_count; ++i) {
                 SymbolPtr param_symb = func_sym->attributes.func_info.params[i];
@@ -761,11 +2010,12 @@ midend::Value* translate_node(
 
                 if (op_name == "&&") {
                     // 对于 &&：如果左边为假，跳到 merge；否则计算右边
-                    builder.createCondBr(left_cond, rhsBB, mergeBB);
+                    create_cond_br(builder, left_cond, rhsBB, mergeBB);
                 } else {  // op_name == "||"
                     // 对于 ||：如果左边为真，跳到 merge；否则计算右边
-                    builder.createCondBr(left_cond, mergeBB, rhsBB);
+                    create_cond_br(builder, left_cond, mergeBB, rhsBB);
                 }
+                ssa_seal_block(rhsBB);
 
                 // 在右操作数基本块中计算右操作数
                 builder.setInsertPoint(rhsBB);
@@ -776,8 +2026,9 @@ midend::Value* translate_node(
                     create_type_tran(builder, right, DATA_BOOL);
                 if (!right) return nullptr;
 
-                builder.createBr(mergeBB);
                 rhsBB = builder.getInsertBlock();  // 可能已经改变
+                create_br(builder, mergeBB);
+                ssa_seal_block(mergeBB);
 
                 // 在合并基本块中创建 PHI 节点
                 builder.setInsertPoint(mergeBB);
@@ -890,7 +2141,12 @@ midend::Value* translate_node(
 
             // 右值
             midend::Value* left_ptr = nullptr;
-            if (left_node->node_type == NODE_VAR) {
+            SymbolPtr ssa_symbol = nullptr;
+            if (left_node->node_type == NODE_VAR &&
+                is_ssa_var(left_node->data.symb_ptr)) {
+                ssa_symbol = left_node->data.symb_ptr;
+                left_type = ssa_symbol->data_type;
+            } else if (left_node->node_type == NODE_VAR) {
                 // 普通变量赋值
                 SymbolPtr symbol = left_node->data.symb_ptr;
                 if (!symbol) return nullptr;
@@ -927,7 +2183,11 @@ midend::Value* translate_node(
                                local_vars, left_type);
             right_value = create_type_tran(builder, right_value, left_type);
             if (!right_value) return nullptr;
-            if (left_ptr) builder.createStore(right_value, left_ptr);
+            if (ssa_symbol)
+                ssa_write_variable(ssa_symbol, builder.getInsertBlock(),
+                                   right_value);
+            else if (left_ptr)
+                builder.createStore(right_value, left_ptr);
             return right_value;
         }
 
@@ -945,6 +2205,7 @@ midend::Value* translate_node(
                 }
                 return_value =
                     create_type_tran(builder, return_value, return_type);
+                if (memo_context.values) emit_memo_store(builder, return_value);
                 builder.createRet(return_value);
             } else {
                 builder.createRetVoid();
@@ -961,6 +2222,29 @@ midend::Value* translate_node(
                 symbol->symbol_type != SYMB_CONST_VAR)
                 return nullptr;
 
+            // 省略的变量只求值初值中的函数调用
+            if (is_elided(symbol)) {
+                if (node->child_count > 0)
+                    translate_discarded_init(node->children[0], symbol,
+                                             builder, current_func,
+                                             local_vars);
+                return nullptr;
+            }
+
+            // SSA形式的局部变量，初始化即定义；无初值时保持之前的定义
+            if (is_ssa_var(symbol)) {
+                if (node->child_count == 0) return nullptr;
+                midend::Value* init_value =
+                    translate_node(node->children[0], builder, current_func,
+                                   local_vars, symbol->data_type);
+                init_value =
+                    create_type_tran(builder, init_value, symbol->data_type);
+                if (init_value)
+                    ssa_write_variable(symbol, builder.getInsertBlock(),
+                                       init_value);
+                return init_value;
+            }
+
             // 查找局部变量
             midend::Value* alloca = nullptr;
             auto it = local_vars.find(symbol->id);
@@ -994,6 +2278,23 @@ midend::Value* translate_node(
                 symbol->symbol_type != SYMB_CONST_ARRAY)
                 return nullptr;
 
+            if (is_elided(symbol)) {
+                if (node->child_count > 1)
+                    translate_discarded_init(node->children[1], symbol,
+                                             builder, current_func,
+                                             local_vars);
+                return nullptr;
+            }
+
+            if (static_arrays.count(symbol)) {
+                auto global = static_cast<midend::GlobalVariable*>(
+                    local_vars[symbol->id]);
+                initialize_static_array(
+                    node->child_count > 1 ? node->children[1] : nullptr,
+                    symbol, global, builder, local_vars);
+                return global;
+            }
+
             // 创建数组类型
             midend::Value* alloca = nullptr;
             auto it = local_vars.find(symbol->id);
@@ -1017,36 +2318,41 @@ midend::Value* translate_node(
             std::string current_block_id = std::to_string(block_idx++);
 
             // 计算条件表达式
-            midend::Value* cond =
-                translate_node(node->children[0], builder, current_func,
-                               local_vars, DATA_BOOL);
-            cond = create_type_tran(builder, cond, DATA_BOOL);
-            if (!cond) return nullptr;
+            Condition cond;
+            if (!translate_condition(node->children[0], builder, current_func,
+                                     local_vars, cond))
+                return nullptr;
             midend::BasicBlock* block_after_cond = builder.getInsertBlock();
 
-            // then基本块
-            midend::BasicBlock* thenBB = builder.createBasicBlock(
-                "if." + current_block_id + ".then", current_func);
-            builder.setInsertPoint(thenBB);
-            translate_node(node->children[1], builder, current_func, local_vars,
-                           need_type);
-            midend::BasicBlock* block_after_then = builder.getInsertBlock();
+            // then基本块，条件恒为假时不生成
+            midend::BasicBlock* thenBB = nullptr;
+            bool then_need_merge = false;
+            if (condition_may_be(cond, true)) {
+                thenBB = builder.createBasicBlock(
+                    "if." + current_block_id + ".then", current_func);
+                builder.setInsertPoint(thenBB);
+                translate_node(node->children[1], builder, current_func,
+                               local_vars, need_type);
+                then_need_merge = !builder.getInsertBlock()->getTerminator();
+            }
 
-            // merge基本块
-            midend::BasicBlock* mergeBB = builder.createBasicBlock(
-                "if." + current_block_id + ".merge", current_func);
+            // merge基本块，条件恒为真且then块不会结束时不生成
+            midend::BasicBlock* mergeBB = nullptr;
+            if (then_need_merge || condition_may_be(cond, false))
+                mergeBB = builder.createBasicBlock(
+                    "if." + current_block_id + ".merge", current_func);
 
             // 如果then块没有终结指令，添加到merge块的跳转
-            if (!block_after_then->getTerminator() &&
-                !in_break_continue_pos(block_after_then))
-                builder.createBr(mergeBB);
+            if (then_need_merge) create_br(builder, mergeBB);
 
             // 根据条件跳转
-            builder.setInsertPoint(block_after_cond);
-            builder.createCondBr(cond, thenBB, mergeBB);
+            emit_condition_br(builder, cond, block_after_cond, thenBB,
+                              mergeBB);
+            ssa_seal_block(thenBB);
+            ssa_seal_block(mergeBB);
 
             // 继续在merge块生成代码
-            builder.setInsertPoint(mergeBB);
+            if (mergeBB) builder.setInsertPoint(mergeBB);
 
             return nullptr;
         }
@@ -1057,34 +2363,39 @@ midend::Value* translate_node(
             std::string current_block_id = std::to_string(block_idx++);
 
             // 计算条件表达式
-            midend::Value* cond =
-                translate_node(node->children[0], builder, current_func,
-                               local_vars, DATA_BOOL);
-            cond = create_type_tran(builder, cond, DATA_BOOL);
-            if (!cond) return nullptr;
+            Condition cond;
+            if (!translate_condition(node->children[0], builder, current_func,
+                                     local_vars, cond))
+                return nullptr;
             midend::BasicBlock* block_after_cond = builder.getInsertBlock();
 
-            // then基本块
-            midend::BasicBlock* thenBB = builder.createBasicBlock(
-                "if." + current_block_id + ".then", current_func);
-            builder.setInsertPoint(thenBB);
-            translate_node(node->children[1], builder, current_func, local_vars,
-                           need_type);
-            midend::BasicBlock* block_after_then = builder.getInsertBlock();
-
-            // else基本块
-            midend::BasicBlock* elseBB = builder.createBasicBlock(
-                "if." + current_block_id + ".else", current_func);
-            builder.setInsertPoint(elseBB);
-            translate_node(node->children[2], builder, current_func, local_vars,
-                           need_type);
-            midend::BasicBlock* block_after_else = builder.getInsertBlock();
+            // then、else基本块，条件恒为假/恒为真时不生成对应的块
+            midend::BasicBlock* thenBB = nullptr;
+            midend::BasicBlock* block_after_then = nullptr;
+            if (condition_may_be(cond, true)) {
+                thenBB = builder.createBasicBlock(
+                    "if." + current_block_id + ".then", current_func);
+                builder.setInsertPoint(thenBB);
+                translate_node(node->children[1], builder, current_func,
+                               local_vars, need_type);
+                block_after_then = builder.getInsertBlock();
+            }
+            midend::BasicBlock* elseBB = nullptr;
+            midend::BasicBlock* block_after_else = nullptr;
+            if (condition_may_be(cond, false)) {
+                elseBB = builder.createBasicBlock(
+                    "if." + current_block_id + ".else", current_func);
+                builder.setInsertPoint(elseBB);
+                translate_node(node->children[2], builder, current_func,
+                               local_vars, need_type);
+                block_after_else = builder.getInsertBlock();
+            }
 
             // 判断是否需要merge块
-            bool then_need_merge = !block_after_then->getTerminator() &&
-                                   !in_break_continue_pos(block_after_then);
-            bool else_need_merge = !block_after_else->getTerminator() &&
-                                   !in_break_continue_pos(block_after_else);
+            bool then_need_merge =
+                block_after_then && !block_after_then->getTerminator();
+            bool else_need_merge =
+                block_after_else && !block_after_else->getTerminator();
 
             // merge基本块
             midend::BasicBlock* mergeBB = nullptr;
@@ -1095,16 +2406,19 @@ midend::Value* translate_node(
             // 如果then、else块没有终结指令，添加到merge块的跳转
             if (then_need_merge) {
                 builder.setInsertPoint(block_after_then);
-                builder.createBr(mergeBB);
+                create_br(builder, mergeBB);
             }
             if (else_need_merge) {
                 builder.setInsertPoint(block_after_else);
-                builder.createBr(mergeBB);
+                create_br(builder, mergeBB);
             }
 
             // 根据条件跳转
-            builder.setInsertPoint(block_after_cond);
-            builder.createCondBr(cond, thenBB, elseBB);
+            emit_condition_br(builder, cond, block_after_cond, thenBB,
+                              elseBB);
+            ssa_seal_block(thenBB);
+            ssa_seal_block(elseBB);
+            ssa_seal_block(mergeBB);
 
             // 继续在merge块生成代码
             if (then_need_merge || else_need_merge)
@@ -1116,74 +2430,71 @@ midend::Value* translate_node(
         case NODE_WHILE_STMT: {
             // while语句处理
             if (node->child_count < 2) return nullptr;
-            int current_block_id_int = block_idx++;
-            std::string current_block_id = std::to_string(current_block_id_int);
+            if (ir_gen_options.rotate_loops)
+                return translate_rotated_while(node, builder, current_func,
+                                               local_vars, need_type);
+            int loop = begin_loop_record(node, builder, local_vars);
+            std::string current_block_id = std::to_string(block_idx++);
 
             // 条件判断块
             midend::BasicBlock* condBB = builder.createBasicBlock(
                 "while." + current_block_id + ".cond", current_func);
 
             // 跳转进入当前基本块
-            builder.createBr(condBB);
+            create_br(builder, condBB);
 
             // 计算条件表达式
             builder.setInsertPoint(condBB);
-            midend::Value* cond =
-                translate_node(node->children[0], builder, current_func,
-                               local_vars, DATA_BOOL);
-            cond = create_type_tran(builder, cond, DATA_BOOL);
-            if (!cond) return nullptr;
+            Condition cond;
+            if (!translate_condition(node->children[0], builder, current_func,
+                                     local_vars, cond))
+                return nullptr;
             midend::BasicBlock* block_after_cond = builder.getInsertBlock();
 
-            // loop基本块
-            midend::BasicBlock* loopBB = builder.createBasicBlock(
-                "while." + current_block_id + ".loop", current_func);
-            builder.setInsertPoint(loopBB);
-            translate_node(node->children[1], builder, current_func, local_vars,
-                           need_type);
-            if (!builder.getInsertBlock()->getTerminator() &&
-                !in_break_continue_pos(builder.getInsertBlock()))
-                builder.createBr(condBB);
-
-            // merge基本块
-            midend::BasicBlock* mergeBB = builder.createBasicBlock(
-                "while." + current_block_id + ".merge", current_func);
-
-            // block_idx单调递增，新进入的break_block对应的一定较大
-            // break指令
-            while (!break_pos.empty()) {
-                BlockDepthPair pair = break_pos.back();
-                if (pair.block_idx < current_block_id_int) break;
-                builder.setInsertPoint(pair.block);
-                builder.createBr(mergeBB);
-                break_pos.pop_back();
-            }
-            // continue指令
-            while (!continue_pos.empty()) {
-                BlockDepthPair pair = continue_pos.back();
-                if (pair.block_idx < current_block_id_int) break;
-                builder.setInsertPoint(pair.block);
-                builder.createBr(condBB);
-                continue_pos.pop_back();
+            // loop基本块，条件恒为假时不生成
+            midend::BasicBlock* loopBB = nullptr;
+            loop_stack.push_back(
+                {current_func, current_block_id, nullptr, condBB});
+            if (condition_may_be(cond, true)) {
+                loopBB = builder.createBasicBlock(
+                    "while." + current_block_id + ".loop", current_func);
+                builder.setInsertPoint(loopBB);
+                translate_node(node->children[1], builder, current_func,
+                               local_vars, need_type);
+                if (!builder.getInsertBlock()->getTerminator())
+                    create_br(builder, condBB);
             }
 
+            // merge基本块，条件恒为真且没有break时循环不会结束，不生成
+            bool exits = condition_may_be(cond, false) &&
+                         !is_true_constant(cond.value);
+            if (exits) loop_break_dest(builder);
+            midend::BasicBlock* mergeBB = loop_stack.back().break_dest;
+            loop_stack.pop_back();
+
             // 跳转指令
-            builder.setInsertPoint(block_after_cond);
-            builder.createCondBr(cond, loopBB, mergeBB);
+            emit_condition_br(builder, cond, block_after_cond, loopBB,
+                              exits ? mergeBB : nullptr);
+            ssa_seal_block(condBB);
+            ssa_seal_block(loopBB);
+            ssa_seal_block(mergeBB);
+            end_loop_record(loop, condBB, mergeBB, {});
 
-            // 继续在merge块生成代码
-            builder.setInsertPoint(mergeBB);
+            // 继续在merge块生成代码，没有merge块时之后的语句不可达
+            if (mergeBB) builder.setInsertPoint(mergeBB);
 
             return nullptr;
         }
 
         case NODE_BREAK_STMT: {
-            break_pos.push_back({builder.getInsertBlock(), block_idx - 1});
+            if (!loop_stack.empty())
+                create_br(builder, loop_break_dest(builder));
             return nullptr;
         }
 
         case NODE_CONTINUE_STMT: {
-            continue_pos.push_back({builder.getInsertBlock(), block_idx - 1});
+            if (!loop_stack.empty())
+                create_br(builder, loop_continue_dest(builder));
             return nullptr;
         }
 
@@ -1196,13 +2507,179 @@ midend::Value* translate_node(
                                    local_vars, need_type);
                 if (node->children[i]->node_type == NODE_BREAK_STMT ||
                     node->children[i]->node_type == NODE_CONTINUE_STMT ||
-                    node->children[i]->node_type == NODE_RETURN_STMT)
+                    node->children[i]->node_type == NODE_RETURN_STMT ||
+                    builder.getInsertBlock()->getTerminator())
                     break;
             }
             return last_value;
     }
 }
 
+// range^param_count不超过size时返回true
+bool memo_range_fits(long long range, int param_count, long long size) {
+    long long total = 1;
+    for (int i = 0; i < param_count; i++) {
+        total *= range;
+        if (total > size) return false;
+    }
+    return true;
+}
+
+// 记忆化函数每个实参可作为下标的取值个数，各实参取值组合的个数不超过表的大小
+int memo_key_range(int param_count) {
+    long long size = std::min(ir_gen_options.memo_table_size, kMemoTableMax);
+    long long range = (long long)std::pow((double)size, 1.0 / param_count);
+    while (range > 0 && !memo_range_fits(range, param_count, size)) range--;
+    while (memo_range_fits(range + 1, param_count, size)) range++;
+    return (int)range;
+}
+
+// 找出可以记忆化的函数：返回int、形参都是int标量、直接或间接递归，且它与
+// 它调用的函数都不访问全局变量、不做输入输出，相同实参的结果总是相同
+std::unordered_set<SymbolPtr> find_memo_funcs() {
+    std::unordered_set<SymbolPtr> memo;
+    for (auto& entry : func_effects) {
+        SymbolPtr func = entry.first;
+        const FunctionEffects& effects = entry.second;
+        if (!effects.recursive || effects.reads_globals ||
+            effects.writes_globals || effects.does_io)
+            continue;
+        FuncInfo& info = func->attributes.func_info;
+        bool int_params = func->data_type == DATA_INT && info.param_count > 0;
+        for (int i = 0; i < info.param_count; i++)
+            if (info.params[i]->symbol_type != SYMB_VAR ||
+                info.params[i]->data_type != DATA_INT)
+                int_params = false;
+        if (int_params && memo_key_range(info.param_count) >= 2)
+            memo.insert(func);
+    }
+    return memo;
+}
+
+// 按副作用摘要为模块中源程序定义的函数记录属性
+void record_function_attributes(midend::Module* module) {
+    for (auto& entry : func_effects) {
+        auto func_it = func_tab.find(entry.first->id);
+        if (func_it == func_tab.end()) continue;
+        const FunctionEffects& effects = entry.second;
+        bool reads_params = false, writes_params = false;
+        FunctionAttributes attributes;
+        for (size_t i = 0; i < effects.reads_param.size(); i++) {
+            reads_params = reads_params || effects.reads_param[i];
+            writes_params = writes_params || effects.writes_param[i];
+            ParamAttributes param;
+            if (entry.first->attributes.func_info.params[i]->symbol_type ==
+                SYMB_ARRAY) {
+                param.noalias = effects.noalias_param[i];
+                param.readonly = !effects.writes_param[i];
+            }
+            attributes.params.push_back(param);
+        }
+        attributes.readonly =
+            !effects.writes_globals && !writes_params && !effects.does_io;
+        attributes.readnone = attributes.readonly && !effects.reads_globals &&
+                              !reads_params;
+        attributes.norecurse = !effects.recursive;
+        set_function_attributes(module, func_it->second,
+                                std::move(attributes));
+    }
+}
+
+// 辅助函数：取记忆化函数的表，不存在时创建（增量编译时沿用已有的表）
+midend::GlobalVariable* get_memo_table(const std::string& name) {
+    note_lazy_entity(name);
+    for (auto global : ir_gen_module->globals())
+        if (global->getName() == name) return global;
+    return midend::GlobalVariable::Create(
+        memo_context.table_type, false, midend::GlobalVariable::InternalLinkage,
+        nullptr, name, ir_gen_module);
+}
+
+// 记忆化函数的入口：实参都在[0, range)内时以它们组成的下标查表，已填写则
+// 直接返回表中的结果，否则执行函数体并在返回前填写表项。范围外的调用使用
+// 表末尾只写不读的一项，返回处不必再判断范围
+void emit_memo_lookup(SymbolPtr func_sym, midend::Function* func,
+                      midend::IRBuilder& builder) {
+    auto ctx = builder.getContext();
+    int param_count = func_sym->attributes.func_info.param_count;
+    int range = memo_key_range(param_count);
+    int entries = 1;
+    for (int i = 0; i < param_count; i++) entries *= range;
+    int shape[1] = {entries + 1};
+    memo_context.table_type = get_array_type(ctx, DATA_INT, 1, shape);
+    memo_context.values = get_memo_table(func->getName() + ".memo");
+    memo_context.filled = get_memo_table(func->getName() + ".memo.filled");
+
+    std::string prefix = "memo." + std::to_string(block_idx++);
+    std::vector<midend::BasicBlock*> range_blocks;
+    for (int i = 1; i < 2 * param_count; i++)
+        range_blocks.push_back(builder.createBasicBlock(
+            prefix + ".range." + std::to_string(i), func));
+    midend::BasicBlock* lookupBB =
+        builder.createBasicBlock(prefix + ".lookup", func);
+    midend::BasicBlock* hitBB = builder.createBasicBlock(prefix + ".hit", func);
+    midend::BasicBlock* bodyBB =
+        builder.createBasicBlock(prefix + ".body", func);
+    range_blocks.push_back(lookupBB);
+
+    // 逐个检查实参的上下界
+    std::vector<midend::BasicBlock*> miss_blocks;
+    for (int i = 0; i < param_count; i++) {
+        midend::Value* arg = func->getArg(i);
+        midend::Value* above = builder.createICmpSGE(
+            arg, builder.getInt32(0), "ge." + std::to_string(var_idx++));
+        miss_blocks.push_back(builder.getInsertBlock());
+        create_cond_br(builder, above, range_blocks[2 * i], bodyBB);
+        builder.setInsertPoint(range_blocks[2 * i]);
+        midend::Value* below = builder.createICmpSLT(
+            arg, builder.getInt32(range), "lt." + std::to_string(var_idx++));
+        miss_blocks.push_back(builder.getInsertBlock());
+        create_cond_br(builder, below, range_blocks[2 * i + 1], bodyBB);
+        builder.setInsertPoint(range_blocks[2 * i + 1]);
+    }
+
+    // 查表
+    midend::Value* index = func->getArg(0);
+    for (int i = 1; i < param_count; i++) {
+        index = builder.createMul(index, builder.getInt32(range),
+                                  "mul." + std::to_string(var_idx++));
+        index = builder.createAdd(index, func->getArg(i),
+                                  "add." + std::to_string(var_idx++));
+    }
+    std::vector<midend::Value*> indices = {index};
+    midend::Value* filled_ptr =
+        builder.createGEP(memo_context.table_type, memo_context.filled,
+                          indices, std::to_string(var_idx++));
+    midend::Value* filled =
+        builder.createLoad(filled_ptr, std::to_string(var_idx++));
+    midend::Value* hit = builder.createICmpNE(
+        filled, builder.getInt32(0), "ne." + std::to_string(var_idx++));
+    create_cond_br(builder, hit, hitBB, bodyBB);
+
+    builder.setInsertPoint(hitBB);
+    midend::Value* value_ptr =
+        builder.createGEP(memo_context.table_type, memo_context.values,
+                          indices, std::to_string(var_idx++));
+    builder.createRet(
+        builder.createLoad(value_ptr, std::to_string(var_idx++)));
+
+    builder.setInsertPoint(bodyBB);
+    midend::PHINode* slot =
+        builder.createPHI(ctx->getInt32Type(), prefix + ".slot");
+    for (midend::BasicBlock* block : miss_blocks)
+        slot->addIncoming(builder.getInt32(entries), block);
+    slot->addIncoming(index, lookupBB);
+    memo_context.slot = slot;
+
+    for (midend::BasicBlock* block : range_blocks) ssa_seal_block(block);
+    ssa_seal_block(hitBB);
+    ssa_seal_block(bodyBB);
+}
+
+// 在已创建的函数中生成函数体
+void translate_func_body(ASTNodePtr node, midend::Module* module,
+                         midend::Function* func);
+
 void translate_func_def(ASTNodePtr node, midend::Module* module,
                         bool enable_mangle_c_std_symbol) {
     if (!node) return;
@@ -1220,6 +2697,7 @@ void translate_func_def(ASTNodePtr node, midend::Module* module,
     FuncInfo func_info = func_sym->attributes.func_info;
 
     // 函数参数节点（函数参数作为局部变量）
+    lowering_func_symbol = func_sym;
     std::vector<midend::Type*> param_types;
     std::vector<std::string> param_names;
     for (int i = 0; i < func_info.param_count; i++) {
@@ -1248,6 +2726,7 @@ void translate_func_def(ASTNodePtr node, midend::Module* module,
         param_types.push_back(param_type);
         param_names.push_back("param." + get_symbol_name(param_sym));
     }
+    lowering_func_symbol = nullptr;
 
     // 创建函数类型
     midend::FunctionType* func_type =
@@ -1259,6 +2738,22 @@ void translate_func_def(ASTNodePtr node, midend::Module* module,
         param_names, module);
     func_tab[func_sym->id] = func;
 
+    translate_func_body(node, module, func);
+}
+
+void translate_func_body(ASTNodePtr node, midend::Module* module,
+                         midend::Function* func) {
+    auto ctx = module->getContext();
+    SymbolPtr func_sym = node->data.symb_ptr;
+    std::string func_name = (func_sym->name) ? func_sym->name : "unknown.func";
+    FuncInfo func_info = func_sym->attributes.func_info;
+    midend::Type* return_type = func->getFunctionType()->getReturnType();
+    // IR变量与基本块在每个函数内分别编号
+    var_idx = 0;
+    block_idx = 0;
+    lowering_func_symbol = func_sym;
+    lowering_lazy_entities.clear();
+
     // 创建基本块
     midend::BasicBlock* entry_bb =
         midend::BasicBlock::Create(ctx, func_name + ".entry", func);
@@ -1266,12 +2761,28 @@ void translate_func_def(ASTNodePtr node, midend::Module* module,
 
     // 函数局部变量
     std::unordered_map<int, midend::Value*> func_local_vars;
+    loop_records.clear();
+    open_loops.clear();
+    stack_estimate = StackEstimate();
+
+    // 直接构造SSA时，标量形参与标量局部变量不分配栈空间
+    SSAState ssa;
+    if (ir_gen_options.direct_ssa) {
+        ssa.ctx = ctx;
+        ssa.sealed.insert(entry_bb);
+        ssa_state = &ssa;
+    }
 
     // 在函数体内部定义函数形参
     for (int i = 0; i < func_info.param_count; i++) {
         SymbolPtr param_sym = func_info.params[i];
         midend::Value* param;
-        if (param_sym->symbol_type == SYMB_VAR) {
+        if (ssa_state && param_sym->symbol_type == SYMB_VAR) {
+            ssa.vars.insert(param_sym->id);
+            function_param_symbols.insert(param_sym->id);
+            ssa_write_variable(param_sym, entry_bb, func->getArg(i));
+            continue;
+        } else if (param_sym->symbol_type == SYMB_VAR) {
             param = def_var(builder, param_sym, func_local_vars);
         } else {
             param = func->getArg(i);
@@ -1282,18 +2793,35 @@ void translate_func_def(ASTNodePtr node, midend::Module* module,
 
     // 定义所有局部变量
     for (int i = 0; i < func_info.var_count; i++) {
-        def_var(builder, func_info.vars[i], func_local_vars);
+        SymbolPtr var_sym = func_info.vars[i];
+        if (is_elided(var_sym)) continue;
+        if (static_arrays.count(var_sym)) {
+            func_local_vars[var_sym->id] =
+                get_static_array(ctx, func, var_sym);
+            stack_estimate.static_bytes += symbol_bytes(var_sym);
+            continue;
+        }
+        if (ssa_state && (var_sym->symbol_type == SYMB_VAR ||
+                          var_sym->symbol_type == SYMB_CONST_VAR)) {
+            ssa.vars.insert(var_sym->id);
+            continue;
+        }
+        def_var(builder, var_sym, func_local_vars);
     }
 
     // 形参赋值给存储在栈中的对象
     for (int i = 0; i < func_info.param_count; i++) {
         SymbolPtr param_sym = func_info.params[i];
-        if (param_sym->symbol_type == SYMB_VAR) {
+        if (param_sym->symbol_type == SYMB_VAR && !is_ssa_var(param_sym)) {
             midend::Value* param_value = func->getArg(i);
             builder.createStore(param_value, func_local_vars[param_sym->id]);
         }
     }
 
+    // 记忆化函数先查表
+    memo_context = MemoContext();
+    if (memo_funcs.count(func_sym)) emit_memo_lookup(func_sym, func, builder);
+
     // 处理函数体
     translate_node(node->children[1], builder, func, func_local_vars,
                    func_sym->data_type);
@@ -1305,37 +2833,252 @@ void translate_func_def(ASTNodePtr node, midend::Module* module,
         else
             builder.createRet(builder.getInt32(0));
     }
+
+    if (ssa_state) {
+        // 此时所有跳转都已生成，封闭剩余的基本块
+        while (!ssa.incomplete_phis.empty())
+            ssa_seal_block(ssa.incomplete_phis.begin()->first);
+        ssa_remove_trivial_phis();
+    }
+    finish_loop_records(module, func);
+    set_stack_estimate(module, func, stack_estimate);
+    ssa_state = nullptr;
+    memo_context = MemoContext();
+    func_lazy_entities[func] = lowering_lazy_entities;
+    lowering_func_symbol = nullptr;
 }
 
+// 全局变量或全局数组的初值，没有初值时返回nullptr
+midend::Constant* translate_global_init(midend::Context* ctx,
+                                        ASTNodePtr node) {
+    SymbolPtr sym = node->data.symb_ptr;
+    switch (node->node_type) {
+        case NODE_VAR_DEF:
+        case NODE_CONST_VAR_DEF:
+            if (node->child_count > 0 && node->children[0] &&
+                node->children[0]->node_type == NODE_CONST)
+                return get_global_type_value(ctx, node->children[0],
+                                             sym->data_type);
+            return nullptr;
+        case NODE_ARRAY_DEF:
+        case NODE_CONST_ARRAY_DEF:
+            if (node->child_count > 1) {
+                midend::Type* array_type = get_array_type(
+                    ctx, sym->data_type, sym->attributes.array_info.dimensions,
+                    sym->attributes.array_info.shape);
+                return process_array_init_list(ctx, node->children[1],
+                                               array_type, sym->data_type);
+            }
+            return nullptr;
+        default:
+            return nullptr;
+    }
+}
+
+// 清空上一次翻译留下的全局表
+void reset_ir_gen_state() {
+    func_tab.clear();
+    global_var_tab.clear();
+    function_param_symbols.clear();
+    loop_stack.clear();
+    const_evaluator.reset();
+    func_effects.clear();
+    memo_funcs.clear();
+    memo_context = MemoContext();
+    pruned_symbols.clear();
+    readonly_globals.clear();
+    static_arrays.clear();
+    func_lazy_entities.clear();
+}
+
+// 收集子树中引用的全局变量与函数
+void collect_global_symbols(ASTNodePtr node, std::vector<SymbolPtr>& syms) {
+    if (!node) return;
+    if (node->data_type == NODEDATA_SYMB && node->data.symb_ptr &&
+        node->data.symb_ptr->scope_level == GLOBAL_SCOPE_LEVEL)
+        syms.push_back(node->data.symb_ptr);
+    for (int i = 0; i < node->child_count; i++)
+        collect_global_symbols(node->children[i], syms);
+}
+
+// 找出从main出发不可达的函数，以及可达函数都不引用的全局变量。
+// 全局变量的初值都是常量，不会引用其它定义；没有main时不裁剪
+std::unordered_set<SymbolPtr> find_pruned_symbols(ASTNodePtr program) {
+    std::unordered_map<SymbolPtr, ASTNodePtr> defs;
+    std::vector<SymbolPtr> pending;
+    for (int i = 0; program && i < program->child_count; i++) {
+        ASTNodePtr child = program->children[i];
+        if (child->data_type != NODEDATA_SYMB || !child->data.symb_ptr)
+            continue;
+        SymbolPtr sym = child->data.symb_ptr;
+        defs[sym] = child;
+        if (child->node_type == NODE_FUNC_DEF && sym->name &&
+            strcmp(sym->name, "main") == 0)
+            pending.push_back(sym);
+    }
+    if (pending.empty()) return {};
+
+    std::unordered_set<SymbolPtr> reached;
+    while (!pending.empty()) {
+        SymbolPtr sym = pending.back();
+        pending.pop_back();
+        if (!reached.insert(sym).second) continue;
+        auto def_it = defs.find(sym);
+        if (def_it != defs.end() &&
+            def_it->second->node_type == NODE_FUNC_DEF)
+            collect_global_symbols(def_it->second, pending);
+    }
+
+    std::unordered_set<SymbolPtr> pruned;
+    for (auto& entry : defs)
+        if (!reached.count(entry.first)) pruned.insert(entry.first);
+    return pruned;
+}
+
+// 找出从未写入的非常量全局变量与全局数组：没有赋值，也没有作为实参
+// 传给写该形参的函数或getarray等输入函数
+std::unordered_set<SymbolPtr> find_readonly_globals(ASTNodePtr program) {
+    std::unordered_set<SymbolPtr> stored;
+    for (auto& entry : func_effects)
+        stored.insert(entry.second.stored_globals.begin(),
+                      entry.second.stored_globals.end());
+
+    std::unordered_set<SymbolPtr> readonly;
+    for (int i = 0; program && i < program->child_count; i++) {
+        ASTNodePtr child = program->children[i];
+        if ((child->node_type != NODE_VAR_DEF &&
+             child->node_type != NODE_ARRAY_DEF) ||
+            child->data_type != NODEDATA_SYMB || !child->data.symb_ptr)
+            continue;
+        if (!stored.count(child->data.symb_ptr))
+            readonly.insert(child->data.symb_ptr);
+    }
+    return readonly;
+}
+
+// 收集语句中不在循环内的局部数组定义
+void collect_once_arrays(ASTNodePtr node, std::vector<SymbolPtr>& arrays) {
+    if (!node || node->node_type == NODE_WHILE_STMT) return;
+    if ((node->node_type == NODE_ARRAY_DEF ||
+         node->node_type == NODE_CONST_ARRAY_DEF) &&
+        node->data_type == NODEDATA_SYMB && node->data.symb_ptr)
+        arrays.push_back(node->data.symb_ptr);
+    for (int i = 0; i < node->child_count; i++)
+        collect_once_arrays(node->children[i], arrays);
+}
+
+// 找出移到静态存储的局部数组：在没有被调用的main中、定义不在循环内
+// （定义至多执行一次），且不小于static_array_min_bytes。数组只能作为实参
+// 传给被调函数，调用返回后不会再经由其它途径访问，因此不会逃逸
+std::unordered_set<SymbolPtr> find_static_arrays(ASTNodePtr program) {
+    std::unordered_set<SymbolPtr> arrays;
+    int min_bytes = ir_gen_options.static_array_min_bytes;
+    for (int i = 0; program && i < program->child_count; i++) {
+        ASTNodePtr child = program->children[i];
+        if (child->node_type != NODE_FUNC_DEF ||
+            child->data_type != NODEDATA_SYMB || !child->data.symb_ptr)
+            continue;
+        SymbolPtr func = child->data.symb_ptr;
+        if (!func->name || strcmp(func->name, "main") != 0 ||
+            func->attributes.func_info.call_count > 0)
+            continue;
+        std::vector<SymbolPtr> defs;
+        if (child->child_count > 1)
+            collect_once_arrays(child->children[1], defs);
+        for (SymbolPtr array : defs)
+            if (symbol_bytes(array) >= min_bytes) arrays.insert(array);
+    }
+    return arrays;
+}
+
+// 全局定义是否生成为内部链接的只读全局变量
+bool is_constant_global(ASTNodePtr def) {
+    return def->node_type == NODE_CONST_VAR_DEF ||
+           def->node_type == NODE_CONST_ARRAY_DEF ||
+           readonly_globals.count(def->data.symb_ptr) > 0;
+}
+
+std::string frontend_options_key(const FrontendOptions& options) {
+    std::string key = options.enable_mangle_c_std_symbol ? "m1" : "m0";
+    key += ".z" + std::to_string((int)options.array_zero_fill);
+    key += ".s" + std::to_string(options.memset_threshold);
+    key += ".t" + std::to_string(options.array_template_min);
+    key += ".p" + std::to_string(options.packed_init_min);
+    key += ".a" + std::to_string((int)options.address_lowering);
+    key += options.fold_array_offsets ? "f1" : "f0";
+    key += options.direct_ssa ? ".ssa1" : ".ssa0";
+    key += options.branch_conditions ? ".bc1" : ".bc0";
+    key += options.rotate_loops ? ".r1" : ".r0";
+    key += options.simplify_exps ? ".x1" : ".x0";
+    key += ".ce" + std::to_string(options.const_eval_steps) + "d" +
+           std::to_string(options.const_eval_depth);
+    key += ".mt" + std::to_string(options.memo_table_size);
+    key += options.prune_unreachable ? ".u1" : ".u0";
+    key += options.elide_unused ? ".e1" : ".e0";
+    key += options.detect_readonly_globals ? ".ro1" : ".ro0";
+    key += ".sa" + std::to_string(options.static_array_min_bytes);
+    return key;
+}
+
+// 设置当前翻译使用的模块与前端选项，program为整个程序的根节点
+void set_ir_gen_context(midend::Module* module, const FrontendOptions& options,
+                        ASTNodePtr program) {
+    ir_gen_module = module;
+    ir_gen_options = options;
+    const_evaluator.reset();
+    if (options.const_eval_steps > 0)
+        const_evaluator = std::make_unique<ConstEvaluator>(
+            program, options.const_eval_steps, options.const_eval_depth);
+    func_effects = analyze_effects(program);
+    memo_funcs.clear();
+    if (options.memo_table_size > 0) memo_funcs = find_memo_funcs();
+    pruned_symbols.clear();
+    if (options.prune_unreachable)
+        pruned_symbols = find_pruned_symbols(program);
+    readonly_globals.clear();
+    if (options.detect_readonly_globals)
+        readonly_globals = find_readonly_globals(program);
+    static_arrays.clear();
+    if (options.static_array_min_bytes > 0)
+        static_arrays = find_static_arrays(program);
+}
+
+// 启用裁剪时，符号的定义是否在翻译时跳过
+bool is_pruned(SymbolPtr sym) { return pruned_symbols.count(sym) > 0; }
+
 // 从根节点开始翻译，处理函数定义
 void translate_root(ASTNodePtr node, midend::Module* module,
-                    bool enable_mangle_c_std_symbol) {
+                    const FrontendOptions& options) {
     auto ctx = module->getContext();
 
     if (!node) return;
+    set_ir_gen_context(module, options, node);
+    clear_module_annotations(module);
 
     // 初始化变量和基本块编号
     var_idx = 0;
     block_idx = 0;
 
+    std::vector<std::string> pruned_names;
     for (int i = 0; i < node->child_count; ++i) {
         ASTNodePtr child = node->children[i];
+        if (child->data_type == NODEDATA_SYMB &&
+            pruned_symbols.count(child->data.symb_ptr)) {
+            pruned_names.push_back(child->data.symb_ptr->name);
+            continue;
+        }
+        if (child->node_type != NODE_FUNC_DEF &&
+            child->data_type == NODEDATA_SYMB && child->data.symb_ptr &&
+            is_elided(child->data.symb_ptr))
+            continue;
         switch (child->node_type) {
             case NODE_VAR_DEF:
             case NODE_CONST_VAR_DEF: {
                 SymbolPtr sym = child->data.symb_ptr;
                 if (!sym) break;
                 midend::Type* var_type = get_ir_type(ctx, sym->data_type);
-                bool is_const = (child->node_type == NODE_CONST_VAR_DEF);
-                // 处理初值
-                midend::Constant* init = nullptr;
-                if (child->child_count > 0 && child->children[0]) {
-                    ASTNodePtr init_node = child->children[0];
-                    if (init_node->node_type == NODE_CONST) {
-                        init = get_global_type_value(ctx, init_node,
-                                                     sym->data_type);
-                    }
-                }
+                bool is_const = is_constant_global(child);
+                midend::Constant* init = translate_global_init(ctx, child);
                 auto linkage = is_const
                                    ? midend::GlobalVariable::InternalLinkage
                                    : midend::GlobalVariable::ExternalLinkage;
@@ -1356,13 +3099,8 @@ void translate_root(ASTNodePtr node, midend::Module* module,
                 midend::Type* array_type = get_array_type(
                     ctx, sym->data_type, sym->attributes.array_info.dimensions,
                     sym->attributes.array_info.shape);
-                bool is_const = (child->node_type == NODE_CONST_ARRAY_DEF);
-                midend::Constant* init = nullptr;
-
-                if (child->child_count > 1) {
-                    init = process_array_init_list(ctx, child->children[1],
-                                                   array_type, sym->data_type);
-                }
+                bool is_const = is_constant_global(child);
+                midend::Constant* init = translate_global_init(ctx, child);
 
                 auto linkage = is_const
                                    ? midend::GlobalVariable::InternalLinkage
@@ -1375,27 +3113,64 @@ void translate_root(ASTNodePtr node, midend::Module* module,
                 break;
             }
             case NODE_FUNC_DEF:
-                translate_func_def(child, module, enable_mangle_c_std_symbol);
+                translate_func_def(child, module,
+                                   options.enable_mangle_c_std_symbol);
                 break;
             default:
                 break;
         }
     }
+    record_function_attributes(module);
+    if (options.prune_unreachable)
+        set_pruned_definitions(module, std::move(pruned_names));
+}
+
+// 读取整个输入文件
+std::string read_source(FILE* file_in) {
+    std::string source;
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file_in)) > 0) source.append(buf, n);
+    return source;
 }
 
 std::unique_ptr<midend::Module> generate_IR(FILE* file_in,
                                             bool enable_mangle_c_std_symbol) {
+    FrontendOptions options;
+    options.enable_mangle_c_std_symbol = enable_mangle_c_std_symbol;
+    return generate_IR(file_in, options);
+}
+
+std::unique_ptr<midend::Module> generate_IR(FILE* file_in,
+                                            const FrontendOptions& options) {
     if (!file_in) return nullptr;
-    yyin = file_in;
+
+    // 启用缓存或多线程解析时整个源文件读入内存；
+    // 启用缓存时先按源文件内容查找，命中则跳过解析与翻译
+    bool use_cache = !options.cache_dir.empty();
+    bool in_memory = use_cache || options.parse_threads > 1;
+    std::string source, cache_key;
+    if (in_memory) source = read_source(file_in);
+    if (use_cache) {
+        cache_key = ir_cache_key(source, options);
+        auto cached = ir_cache_load(options.cache_dir, cache_key);
+        if (cached) return cached;
+    }
 
     auto ctx = new midend::Context();
     auto module = std::make_unique<midend::Module>("main", ctx);
 
+    reset_ir_gen_state();
     init_symbol_management();
     add_runtime_lib_to_symbol_table();
+    packed_init_min = options.packed_init_min;
+    simplify_exps = options.simplify_exps;
 
+    int parse_result =
+        in_memory ? parse_source(source, options.parse_threads, &root)
+                  : parse_file(file_in, &root);
 #ifdef DEBUG
-    if (!yyparse()) {
+    if (!parse_result) {
         printf("Parsing completed successfully.\n\n");
         printf("--- Abstract Syntax Tree ---\n");
         print_ast(root, 0);
@@ -1403,12 +3178,10 @@ std::unique_ptr<midend::Module> generate_IR(FILE* file_in,
     } else {
         printf("Parsing failed.\n");
     }
-#else
-    yyparse();
 #endif
 
     add_runtime_lib_to_func_tab(module.get());
-    translate_root(root, module.get(), enable_mangle_c_std_symbol);
+    translate_root(root, module.get(), options);
 
 #ifdef DEBUG
     if (module) {
@@ -1420,7 +3193,33 @@ std::unique_ptr<midend::Module> generate_IR(FILE* file_in,
     }
 #endif
 
+    // 只缓存解析成功的结果
+    if (use_cache && !parse_result)
+        ir_cache_store(options.cache_dir, cache_key, module.get());
+
     if (root) free_ast(root);
+    root = NULL;
+    free_symbol_management();
+    return module;
+}
+
+std::unique_ptr<midend::Module> generate_IR_from_ast(
+    const void* data, size_t size, const FrontendOptions& options) {
+    reset_ir_gen_state();
+    init_symbol_management();
+    ASTNodePtr program = deserialize_program(data, size);
+    if (!program) {
+        free_symbol_management();
+        return nullptr;
+    }
+    bind_runtime_lib_symbols();
+
+    auto ctx = new midend::Context();
+    auto module = std::make_unique<midend::Module>("main", ctx);
+    add_runtime_lib_to_func_tab(module.get());
+    translate_root(program, module.get(), options);
+
+    free_ast(program);
     free_symbol_management();
     return module;
 }
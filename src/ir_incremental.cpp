@@ -0,0 +1,489 @@
+#include "ir_incremental.h"
+
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "IR/BasicBlock.h"
+#include "IR/Function.h"
+#include "IR/Module.h"
+
+extern "C" {
+#include "sy_parser/AST.h"
+#include "sy_parser/prescan.h"
+#include "sy_parser/symbol_table.h"
+
+extern ASTNodePtr root;
+}
+
+#include "ir_annotations.h"
+#include "parallel_parse.h"
+#include "runtime_lib_def.h"
+
+// ir_gen.cpp中的翻译状态与翻译函数
+extern std::unordered_map<int, midend::Function*> func_tab;
+extern std::unordered_map<int, midend::GlobalVariable*> global_var_tab;
+extern std::unordered_map<midend::Function*, std::vector<std::string>>
+    func_lazy_entities;
+
+std::string read_source(FILE* file_in);
+std::string get_symbol_name(SymbolPtr symbol);
+void reset_ir_gen_state();
+void translate_root(ASTNodePtr node, midend::Module* module,
+                    const FrontendOptions& options);
+void set_ir_gen_context(midend::Module* module, const FrontendOptions& options,
+                        ASTNodePtr program);
+void translate_func_body(ASTNodePtr node, midend::Module* module,
+                         midend::Function* func);
+void record_function_attributes(midend::Module* module);
+bool is_pruned(SymbolPtr sym);
+bool is_elided(SymbolPtr symbol);
+bool is_constant_global(ASTNodePtr def);
+midend::Constant* translate_global_init(midend::Context* ctx, ASTNodePtr node);
+
+namespace {
+
+// 64位FNV-1a
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t hash_int(uint64_t hash, int value) {
+    return hash_bytes(hash, &value, sizeof(value));
+}
+
+uint64_t hash_str(uint64_t hash, const char* str) {
+    if (!str) return hash_int(hash, -1);
+    return hash_bytes(hash, str, strlen(str) + 1);
+}
+
+const uint64_t kHashSeed = 0xcbf29ce484222325ULL;
+
+// 源程序片段的记号摘要：忽略注释，连续空白视为一个分隔符
+uint64_t hash_tokens(const char* src, size_t begin, size_t end) {
+    uint64_t hash = kHashSeed;
+    bool pending_space = false;
+    size_t pos = begin;
+    while (pos < end) {
+        char c = src[pos];
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' ||
+            c == '\v') {
+            pending_space = true;
+            pos++;
+            continue;
+        }
+        if (c == '/' && pos + 1 < end && src[pos + 1] == '/') {
+            while (pos < end && src[pos] != '\n') pos++;
+            pending_space = true;
+            continue;
+        }
+        if (c == '/' && pos + 1 < end && src[pos + 1] == '*') {
+            pos += 2;
+            while (pos + 1 < end && !(src[pos] == '*' && src[pos + 1] == '/'))
+                pos++;
+            pos = (pos + 2 < end) ? pos + 2 : end;
+            pending_space = true;
+            continue;
+        }
+        if (pending_space) {
+            hash = hash_bytes(hash, " ", 1);
+            pending_space = false;
+        }
+        hash = hash_bytes(hash, &c, 1);
+        pos++;
+    }
+    return hash;
+}
+
+// AST子树摘要，符号按名字而非编号计入（编号随源程序中的位置变化）
+uint64_t hash_ast(uint64_t hash, ASTNodePtr node) {
+    if (!node) return hash_int(hash, -1);
+    hash = hash_int(hash, node->node_type);
+    hash = hash_int(hash, node->data_type);
+    switch (node->data_type) {
+        case NODEDATA_SYMB:
+            hash = hash_str(hash, node->data.symb_ptr
+                                      ? node->data.symb_ptr->name
+                                      : nullptr);
+            break;
+        case NODEDATA_INT:
+            hash = hash_int(hash, node->data.direct_int);
+            break;
+        case NODEDATA_FLOAT:
+            hash = hash_bytes(hash, &node->data.direct_float,
+                              sizeof(node->data.direct_float));
+            break;
+        case NODEDATA_STRING:
+            hash = hash_str(hash, node->data.direct_str);
+            break;
+        case NODEDATA_TYPE:
+            hash = hash_int(hash, node->data.data_type);
+            break;
+        case NODEDATA_PACKED:
+            hash = hash_int(hash, node->data.packed->elem_type);
+            hash = hash_int(hash, node->data.packed->length);
+            hash = hash_bytes(hash, node->data.packed->values.ints,
+                              sizeof(int) * node->data.packed->length);
+            hash = hash_bytes(hash, node->data.packed->expr_offsets,
+                              sizeof(int) * node->child_count);
+            break;
+        default:
+            break;
+    }
+    hash = hash_int(hash, node->child_count);
+    for (int i = 0; i < node->child_count; i++)
+        hash = hash_ast(hash, node->children[i]);
+    return hash;
+}
+
+// 符号签名：名字、种类、类型、数组形状，函数还包括各参数的签名
+uint64_t hash_signature(uint64_t hash, SymbolPtr sym) {
+    hash = hash_str(hash, sym->name);
+    hash = hash_int(hash, sym->symbol_type);
+    hash = hash_int(hash, sym->data_type);
+    switch (sym->symbol_type) {
+        case SYMB_ARRAY:
+        case SYMB_CONST_ARRAY:
+            hash = hash_int(hash, sym->attributes.array_info.dimensions);
+            for (int i = 0; i < sym->attributes.array_info.dimensions; i++)
+                hash = hash_int(hash, sym->attributes.array_info.shape[i]);
+            break;
+        case SYMB_FUNCTION:
+            hash = hash_int(hash, sym->attributes.func_info.param_count);
+            for (int i = 0; i < sym->attributes.func_info.param_count; i++)
+                hash = hash_signature(hash,
+                                      sym->attributes.func_info.params[i]);
+            break;
+        default:
+            break;
+    }
+    return hash;
+}
+
+// 收集子树中引用的全局符号（全局变量与函数）
+void collect_global_refs(ASTNodePtr node, std::set<std::string>& refs,
+                         std::vector<SymbolPtr>& syms) {
+    if (!node) return;
+    if (node->data_type == NODEDATA_SYMB && node->data.symb_ptr) {
+        SymbolPtr sym = node->data.symb_ptr;
+        if (sym->scope_level == GLOBAL_SCOPE_LEVEL && sym->name &&
+            refs.insert(sym->name).second)
+            syms.push_back(sym);
+    }
+    for (int i = 0; i < node->child_count; i++)
+        collect_global_refs(node->children[i], refs, syms);
+}
+
+// 顶层定义节点的符号
+SymbolPtr def_symbol(ASTNodePtr node) {
+    return (node && node->data_type == NODEDATA_SYMB) ? node->data.symb_ptr
+                                                      : nullptr;
+}
+
+bool is_global_def(ASTNodePtr node) {
+    return node->node_type == NODE_VAR_DEF ||
+           node->node_type == NODE_CONST_VAR_DEF ||
+           node->node_type == NODE_ARRAY_DEF ||
+           node->node_type == NODE_CONST_ARRAY_DEF;
+}
+
+// 当前符号表中的运行库函数（未在源程序中定义的全局函数）
+std::vector<SymbolPtr> runtime_lib_symbols(
+    const std::unordered_set<std::string>& defined_funcs) {
+    std::vector<SymbolPtr> syms;
+    for (int id = 0;; id++) {
+        SymbolPtr sym = get_symbol_by_id(id);
+        if (!sym) break;
+        if (sym->symbol_type == SYMB_FUNCTION &&
+            sym->scope_level == GLOBAL_SCOPE_LEVEL &&
+            sym->name && !defined_funcs.count(sym->name))
+            syms.push_back(sym);
+    }
+    return syms;
+}
+
+// 本次解析得到的各实体指纹
+struct Fingerprints {
+    uint64_t skeleton;
+    std::unordered_map<std::string, uint64_t> funcs;
+    std::unordered_map<std::string, uint64_t> global_values;
+};
+
+void compute_fingerprints(const std::string& source,
+                          const TopLevelUnits& units,
+                          const FrontendOptions& options, Fingerprints& fp) {
+    std::unordered_map<std::string, uint64_t> unit_tokens;
+    for (int i = 0; i < units.unit_count; i++) {
+        const TopLevelUnit& unit = units.units[i];
+        if (unit.kind == UNIT_FUNC && unit.name)
+            unit_tokens[unit.name] =
+                hash_tokens(source.data(), unit.begin, unit.end);
+    }
+
+    // 全局实体的种类、顺序与签名，任何变化都需要重建整个模块。符号编号
+    // 不计入：局部变量与形参的IR名称按相对函数的编号，全局变量改名即可
+    std::unordered_set<std::string> defined_funcs;
+    uint64_t skeleton =
+        hash_str(kHashSeed, frontend_options_key(options).c_str());
+    for (int i = 0; i < root->child_count; i++) {
+        ASTNodePtr child = root->children[i];
+        SymbolPtr sym = def_symbol(child);
+        if (!sym ||
+            (child->node_type != NODE_FUNC_DEF && !is_global_def(child)))
+            continue;
+        skeleton = hash_int(skeleton, child->node_type);
+        skeleton = hash_signature(skeleton, sym);
+        if (child->node_type == NODE_FUNC_DEF)
+            defined_funcs.insert(sym->name);
+        else
+            fp.global_values[sym->name] = hash_ast(kHashSeed, child);
+    }
+    // 运行库函数只在被调用时声明
+    for (SymbolPtr sym : runtime_lib_symbols(defined_funcs)) {
+        skeleton = hash_str(skeleton, sym->name);
+        skeleton = hash_int(skeleton, sym->attributes.func_info.call_count > 0);
+    }
+    fp.skeleton = skeleton;
+
+    // 函数指纹：记号摘要、AST摘要（常量折叠后的值不一定出现在记号中）、
+    // 引用的函数签名与全局变量初值
+    std::unordered_map<std::string, std::vector<std::string>> callees;
+    for (int i = 0; i < root->child_count; i++) {
+        ASTNodePtr child = root->children[i];
+        SymbolPtr sym = def_symbol(child);
+        if (child->node_type != NODE_FUNC_DEF || !sym) continue;
+        uint64_t hash = kHashSeed;
+        auto token_it = unit_tokens.find(sym->name);
+        if (token_it != unit_tokens.end())
+            hash = hash_bytes(hash, &token_it->second, sizeof(uint64_t));
+        hash = hash_ast(hash, child);
+        // 局部数组能否移到静态存储取决于函数是否被调用
+        if (options.static_array_min_bytes > 0)
+            hash = hash_int(hash, sym->attributes.func_info.call_count > 0);
+
+        std::set<std::string> refs;
+        std::vector<SymbolPtr> ref_syms;
+        collect_global_refs(child, refs, ref_syms);
+        for (const std::string& name : refs) {
+            hash = hash_str(hash, name.c_str());
+            auto value_it = fp.global_values.find(name);
+            if (value_it != fp.global_values.end())
+                hash = hash_bytes(hash, &value_it->second, sizeof(uint64_t));
+        }
+        for (SymbolPtr ref : ref_syms)
+            if (ref->symbol_type == SYMB_FUNCTION) {
+                hash = hash_signature(hash, ref);
+                callees[sym->name].push_back(ref->name);
+            }
+        fp.funcs[sym->name] = hash;
+    }
+
+    // 编译期求值的调用结果与能否记忆化取决于被调函数（及其间接调用的
+    // 函数）的定义，它们变化时调用者也需要重新翻译
+    if (options.const_eval_steps <= 0 && options.memo_table_size <= 0) return;
+    std::unordered_map<std::string, uint64_t> own = fp.funcs;
+    for (auto& entry : fp.funcs) {
+        std::set<std::string> reached;
+        std::vector<std::string> pending(callees[entry.first]);
+        while (!pending.empty()) {
+            std::string name = pending.back();
+            pending.pop_back();
+            if (!reached.insert(name).second) continue;
+            for (const std::string& next : callees[name])
+                pending.push_back(next);
+        }
+        for (const std::string& name : reached) {
+            auto own_it = own.find(name);
+            if (own_it != own.end())
+                entry.second = hash_bytes(entry.second, &own_it->second,
+                                          sizeof(uint64_t));
+        }
+    }
+}
+
+// 清空函数体，保留函数对象本身以维持调用者中的引用
+void clear_function_body(midend::Function* func) {
+    std::vector<midend::BasicBlock*> blocks(func->begin(), func->end());
+    for (midend::BasicBlock* block : blocks)
+        for (midend::Instruction* inst : *block) inst->dropAllReferences();
+    for (midend::BasicBlock* block : blocks) block->eraseFromParent();
+}
+
+// 按需创建的实体在模块中的布局：按函数顺序，每个实体记在第一个用到它的
+// 函数名下
+std::vector<std::pair<std::string, std::string>> lazy_entity_layout(
+    const std::vector<std::string>& funcs,
+    std::unordered_map<std::string, std::vector<std::string>>& entities) {
+    std::vector<std::pair<std::string, std::string>> layout;
+    std::unordered_set<std::string> seen;
+    for (const std::string& func : funcs)
+        for (const std::string& entity : entities[func])
+            if (seen.insert(entity).second) layout.push_back({func, entity});
+    return layout;
+}
+
+// 完整生成模块并记录其中的实体
+void full_rebuild(const FrontendOptions& options, Fingerprints& fp,
+                  IncrementalState& state, IncrementalStats& stats) {
+    auto ctx = new midend::Context();
+    auto module = std::make_unique<midend::Module>("main", ctx);
+    add_runtime_lib_to_func_tab(module.get());
+    translate_root(root, module.get(), options);
+
+    state.functions.clear();
+    state.globals.clear();
+    for (auto& entry : func_tab)
+        state.functions[get_symbol_by_id(entry.first)->name] = entry.second;
+    for (auto& entry : global_var_tab)
+        state.globals[get_symbol_by_id(entry.first)->name] = entry.second;
+    state.lazy_entities.clear();
+    for (auto& entry : func_lazy_entities)
+        state.lazy_entities[entry.first->getName()] = entry.second;
+
+    if (state.module) clear_module_annotations(state.module.get());
+    state.module = std::move(module);
+    stats.full_rebuild = true;
+    stats.relowered = (int)fp.funcs.size();
+}
+
+// 沿用模块中的全局实体，只重新翻译指纹变化的函数
+bool incremental_update(const FrontendOptions& options, Fingerprints& fp,
+                        IncrementalState& state, IncrementalStats& stats) {
+    midend::Module* module = state.module.get();
+    std::unordered_set<std::string> defined_funcs;
+    set_ir_gen_context(module, options, root);
+
+    // 先建立新符号到已有对象的映射，重新翻译的函数会通过它们引用全局实体。
+    // 裁剪或省略的定义不在模块中，这些定义或只读的全局变量变化时整体重建
+    for (int i = 0; i < root->child_count; i++) {
+        ASTNodePtr child = root->children[i];
+        SymbolPtr sym = def_symbol(child);
+        if (!sym) continue;
+        if (child->node_type == NODE_FUNC_DEF) {
+            defined_funcs.insert(sym->name);
+            auto it = state.functions.find(sym->name);
+            if ((it == state.functions.end()) != is_pruned(sym)) return false;
+            if (it != state.functions.end()) func_tab[sym->id] = it->second;
+        } else if (is_global_def(child)) {
+            auto it = state.globals.find(sym->name);
+            bool skipped = is_pruned(sym) || is_elided(sym);
+            if ((it == state.globals.end()) != skipped) return false;
+            if (it != state.globals.end() &&
+                it->second->isConstant() != is_constant_global(child))
+                return false;
+            if (it == state.globals.end()) continue;
+            global_var_tab[sym->id] = it->second;
+            // 全局变量名含符号编号，前面的函数增删局部变量时随之变化
+            std::string name = get_symbol_name(sym);
+            if (it->second->getName() != name) it->second->setName(name);
+        }
+    }
+    for (SymbolPtr sym : runtime_lib_symbols(defined_funcs)) {
+        if (!sym->attributes.func_info.call_count) continue;
+        auto it = state.functions.find(sym->name);
+        if (it == state.functions.end()) return false;
+        func_tab[sym->id] = it->second;
+    }
+
+    // 更新初值变化的全局变量
+    for (int i = 0; i < root->child_count; i++) {
+        ASTNodePtr child = root->children[i];
+        SymbolPtr sym = def_symbol(child);
+        if (!sym || !is_global_def(child) || is_pruned(sym) || is_elided(sym))
+            continue;
+        if (fp.global_values[sym->name] != state.global_values[sym->name])
+            global_var_tab[sym->id]->setInitializer(
+                translate_global_init(module->getContext(), child));
+    }
+
+    // 函数体的IR只取决于函数本身，指纹不变的函数直接沿用
+    std::vector<std::string> lowered_funcs;
+    std::unordered_map<std::string, std::vector<std::string>> lazy_entities;
+    for (int i = 0; i < root->child_count; i++) {
+        ASTNodePtr child = root->children[i];
+        SymbolPtr sym = def_symbol(child);
+        if (child->node_type != NODE_FUNC_DEF || !sym || is_pruned(sym))
+            continue;
+        midend::Function* func = func_tab[sym->id];
+        lowered_funcs.push_back(func->getName());
+        auto old_it = state.func_fingerprints.find(sym->name);
+        if (old_it != state.func_fingerprints.end() &&
+            old_it->second == fp.funcs[sym->name]) {
+            lazy_entities[func->getName()] =
+                state.lazy_entities[func->getName()];
+            stats.reused++;
+            continue;
+        }
+        clear_function_body(func);
+        translate_func_body(child, module, func);
+        lazy_entities[func->getName()] = func_lazy_entities[func];
+        stats.relowered++;
+    }
+    // 重新翻译的函数沿用模块中的同名实体。实体增删或第一个用到它的函数
+    // 变化时，它在模块中的位置与完整生成不同，整体重建
+    if (lazy_entity_layout(lowered_funcs, lazy_entities) !=
+        lazy_entity_layout(lowered_funcs, state.lazy_entities))
+        return false;
+    state.lazy_entities = std::move(lazy_entities);
+    // 被调函数变化时未重新翻译的函数的属性也可能变化
+    record_function_attributes(module);
+    return true;
+}
+
+}  // namespace
+
+IncrementalState::~IncrementalState() {
+    if (module) clear_module_annotations(module.get());
+}
+
+bool regenerate_IR(FILE* file_in, const FrontendOptions& options,
+                   IncrementalState& state, IncrementalStats* stats) {
+    IncrementalStats local_stats = {0, 0, false};
+    if (!file_in) return false;
+
+    std::string source = read_source(file_in);
+    // 预扫描失败时单元为空，函数指纹只由AST摘要与依赖组成
+    TopLevelUnits units;
+    prescan_top_level(source.data(), source.size(), &units);
+
+    reset_ir_gen_state();
+    init_symbol_management();
+    add_runtime_lib_to_symbol_table();
+    packed_init_min = options.packed_init_min;
+    simplify_exps = options.simplify_exps;
+    int parse_result = parse_source(source, options.parse_threads, &root);
+
+    bool ok = !parse_result && root;
+    if (ok) {
+        Fingerprints fp;
+        compute_fingerprints(source, units, options, fp);
+
+        bool reusable = state.module && state.skeleton == fp.skeleton;
+        if (!reusable || !incremental_update(options, fp, state, local_stats)) {
+            // 旧模块中找不到对应实体或函数无法在原位置重新翻译时整体重建
+            reset_ir_gen_state();
+            local_stats = {0, 0, false};
+            full_rebuild(options, fp, state, local_stats);
+        }
+        state.skeleton = fp.skeleton;
+        state.func_fingerprints = fp.funcs;
+        state.global_values = fp.global_values;
+    }
+
+    free_top_level_units(&units);
+    if (root) free_ast(root);
+    root = nullptr;
+    free_symbol_management();
+    if (stats) *stats = local_stats;
+    return ok;
+}
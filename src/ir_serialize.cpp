@@ -0,0 +1,1186 @@
+#include "ir_serialize.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "IR/BasicBlock.h"
+#include "IR/Function.h"
+#include "IR/IRBuilder.h"
+#include "IR/Module.h"
+#include "IR/Type.h"
+#include "ir_annotations.h"
+
+// 二进制IR格式：
+//   头部    "SYIR" 版本号 标志位
+//   字符串表 类型表 全局变量 函数声明 函数体
+// 每个函数体后跟前端为它记录的函数属性、栈帧估计与循环结构
+// （ir_annotations.h），块与值按函数内的编号引用；最后是裁剪掉的定义名。
+// 除浮点常量外的整数均使用LEB128变长编码。
+// 常量数组按连续相同元素分段（段长+元素）写出，大量零初值只占几个字节。
+namespace {
+
+const char kMagic[4] = {'S', 'Y', 'I', 'R'};
+const uint64_t kVersion = 6;
+
+// 标志位：不含局部名称（基本块、指令、形参）
+const uint64_t kFlagNoLocalNames = 1;
+
+enum TypeKind : uint8_t {
+    TYPE_VOID,
+    TYPE_INT,
+    TYPE_FLOAT,
+    TYPE_POINTER,
+    TYPE_ARRAY,
+    TYPE_FUNCTION,
+};
+
+enum ValueTag : uint8_t {
+    VALUE_NULL,
+    VALUE_INST,
+    VALUE_ARG,
+    VALUE_GLOBAL,
+    VALUE_FUNC,
+    VALUE_CONST_INT,
+    VALUE_CONST_FP,
+    VALUE_CONST_ARRAY,
+};
+
+// 前端会生成的指令种类
+enum OpKind : uint8_t {
+    OP_ALLOCA,
+    OP_LOAD,
+    OP_STORE,
+    OP_GEP,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_REM,
+    OP_FADD,
+    OP_FSUB,
+    OP_FMUL,
+    OP_FDIV,
+    OP_ICMP_EQ,
+    OP_ICMP_NE,
+    OP_ICMP_SLT,
+    OP_ICMP_SLE,
+    OP_ICMP_SGT,
+    OP_ICMP_SGE,
+    OP_FCMP_OEQ,
+    OP_FCMP_ONE,
+    OP_FCMP_OLT,
+    OP_FCMP_OLE,
+    OP_FCMP_OGT,
+    OP_FCMP_OGE,
+    OP_USUB,
+    OP_SITOFP,
+    OP_FPTOSI,
+    OP_CALL,
+    OP_RET,
+    OP_RET_VOID,
+    OP_BR,
+    OP_COND_BR,
+    OP_PHI,
+    OP_UNKNOWN,
+};
+
+// 名称索引0表示无名称
+const uint64_t kNoName = 0;
+
+class ByteWriter {
+   public:
+    explicit ByteWriter(std::string& out) : out_(out) {}
+
+    void u8(uint8_t v) { out_.push_back((char)v); }
+    void varint(uint64_t v) {
+        while (v >= 0x80) {
+            out_.push_back((char)((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        out_.push_back((char)v);
+    }
+    void svarint(int64_t v) {
+        varint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+    }
+    void f32(float v) {
+        char bytes[4];
+        memcpy(bytes, &v, 4);
+        out_.append(bytes, 4);
+    }
+    void bytes(const char* data, size_t len) { out_.append(data, len); }
+
+   private:
+    std::string& out_;
+};
+
+class ByteReader {
+   public:
+    ByteReader(const char* data, size_t size)
+        : data_(data), size_(size), pos_(0), ok_(true) {}
+
+    bool ok() const { return ok_; }
+    bool at_end() const { return pos_ >= size_; }
+
+    uint8_t u8() {
+        if (pos_ >= size_) return fail();
+        return (uint8_t)data_[pos_++];
+    }
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= size_) return fail();
+            uint8_t byte = (uint8_t)data_[pos_++];
+            v |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+        return fail();
+    }
+    int64_t svarint() {
+        uint64_t v = varint();
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+    float f32() {
+        float v = 0.0;
+        if (pos_ + 4 > size_) return (float)fail();
+        memcpy(&v, data_ + pos_, 4);
+        pos_ += 4;
+        return v;
+    }
+    const char* bytes(size_t len) {
+        if (pos_ + len > size_) {
+            fail();
+            return nullptr;
+        }
+        const char* p = data_ + pos_;
+        pos_ += len;
+        return p;
+    }
+
+   private:
+    uint8_t fail() {
+        ok_ = false;
+        pos_ = size_;
+        return 0;
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+    bool ok_;
+};
+
+// 将指令归类为格式中的指令种类
+OpKind classify_instruction(midend::Instruction* inst) {
+    if (dynamic_cast<midend::AllocaInst*>(inst)) return OP_ALLOCA;
+    if (dynamic_cast<midend::LoadInst*>(inst)) return OP_LOAD;
+    if (dynamic_cast<midend::StoreInst*>(inst)) return OP_STORE;
+    if (dynamic_cast<midend::GetElementPtrInst*>(inst)) return OP_GEP;
+    if (dynamic_cast<midend::PHINode*>(inst)) return OP_PHI;
+    if (dynamic_cast<midend::CallInst*>(inst)) return OP_CALL;
+    if (dynamic_cast<midend::UnaryOperator*>(inst)) return OP_USUB;
+    if (auto ret = dynamic_cast<midend::ReturnInst*>(inst))
+        return ret->getReturnValue() ? OP_RET : OP_RET_VOID;
+    if (auto br = dynamic_cast<midend::BranchInst*>(inst))
+        return br->isConditional() ? OP_COND_BR : OP_BR;
+    if (auto cast = dynamic_cast<midend::CastInst*>(inst)) {
+        switch (cast->getCastOpcode()) {
+            case midend::CastInst::CastOps::SIToFP:
+                return OP_SITOFP;
+            case midend::CastInst::CastOps::FPToSI:
+                return OP_FPTOSI;
+            default:
+                return OP_UNKNOWN;
+        }
+    }
+    if (auto cmp = dynamic_cast<midend::CmpInst*>(inst)) {
+        switch (cmp->getPredicate()) {
+            case midend::CmpInst::ICMP_EQ:
+                return OP_ICMP_EQ;
+            case midend::CmpInst::ICMP_NE:
+                return OP_ICMP_NE;
+            case midend::CmpInst::ICMP_SLT:
+                return OP_ICMP_SLT;
+            case midend::CmpInst::ICMP_SLE:
+                return OP_ICMP_SLE;
+            case midend::CmpInst::ICMP_SGT:
+                return OP_ICMP_SGT;
+            case midend::CmpInst::ICMP_SGE:
+                return OP_ICMP_SGE;
+            case midend::CmpInst::FCMP_OEQ:
+                return OP_FCMP_OEQ;
+            case midend::CmpInst::FCMP_ONE:
+                return OP_FCMP_ONE;
+            case midend::CmpInst::FCMP_OLT:
+                return OP_FCMP_OLT;
+            case midend::CmpInst::FCMP_OLE:
+                return OP_FCMP_OLE;
+            case midend::CmpInst::FCMP_OGT:
+                return OP_FCMP_OGT;
+            case midend::CmpInst::FCMP_OGE:
+                return OP_FCMP_OGE;
+            default:
+                return OP_UNKNOWN;
+        }
+    }
+    if (auto bin = dynamic_cast<midend::BinaryOperator*>(inst)) {
+        switch (bin->getOpcode()) {
+            case midend::Opcode::Add:
+                return OP_ADD;
+            case midend::Opcode::Sub:
+                return OP_SUB;
+            case midend::Opcode::Mul:
+                return OP_MUL;
+            case midend::Opcode::Div:
+                return OP_DIV;
+            case midend::Opcode::Rem:
+                return OP_REM;
+            case midend::Opcode::FAdd:
+                return OP_FADD;
+            case midend::Opcode::FSub:
+                return OP_FSUB;
+            case midend::Opcode::FMul:
+                return OP_FMUL;
+            case midend::Opcode::FDiv:
+                return OP_FDIV;
+            default:
+                return OP_UNKNOWN;
+        }
+    }
+    return OP_UNKNOWN;
+}
+
+// 两个标量常量是否相同（常量数组分段用）
+bool same_constant(midend::Value* a, midend::Value* b) {
+    if (a == b) return true;
+    if (!a || !b || a->getType() != b->getType()) return false;
+    auto int_a = dynamic_cast<midend::ConstantInt*>(a);
+    auto int_b = dynamic_cast<midend::ConstantInt*>(b);
+    if (int_a && int_b) return int_a->getValue() == int_b->getValue();
+    auto fp_a = dynamic_cast<midend::ConstantFP*>(a);
+    auto fp_b = dynamic_cast<midend::ConstantFP*>(b);
+    if (fp_a && fp_b) {
+        float va = fp_a->getValue(), vb = fp_b->getValue();
+        return memcmp(&va, &vb, sizeof(float)) == 0;
+    }
+    return false;
+}
+
+class ModuleWriter {
+   public:
+    ModuleWriter(midend::Module* module, bool keep_local_names)
+        : module_(module), keep_local_names_(keep_local_names) {}
+
+    bool write(std::string& out) {
+        std::string body;
+        ByteWriter w(body);
+
+        // 全局变量与函数编号
+        std::vector<midend::GlobalVariable*> globals;
+        for (auto global : module_->globals()) {
+            global_idx_[global] = globals.size();
+            globals.push_back(global);
+        }
+        std::vector<midend::Function*> funcs;
+        for (auto func : *module_) {
+            func_idx_[func] = funcs.size();
+            funcs.push_back(func);
+        }
+
+        // 全局变量
+        w.varint(globals.size());
+        for (auto global : globals) {
+            w.varint(intern_string(global->getName()));
+            w.varint(intern_type(global->getValueType()));
+            w.u8(global->isConstant() ? 1 : 0);
+            w.u8(global->getLinkage() ==
+                         midend::GlobalVariable::InternalLinkage
+                     ? 1
+                     : 0);
+            if (global->hasInitializer()) {
+                w.u8(1);
+                if (!write_value(w, global->getInitializer())) return false;
+            } else {
+                w.u8(0);
+            }
+        }
+
+        // 函数声明
+        w.varint(funcs.size());
+        for (auto func : funcs) {
+            w.varint(intern_string(func->getName()));
+            w.varint(intern_type(func->getFunctionType()));
+            w.varint(func->getNumArgs());
+            for (size_t i = 0; i < func->getNumArgs(); i++)
+                w.varint(local_name(func->getArg(i)->getName()));
+        }
+
+        // 函数体及其记录
+        for (auto func : funcs) {
+            if (!write_function_body(w, func) ||
+                !write_function_annotations(w, func))
+                return false;
+        }
+
+        // 裁剪记录
+        const std::vector<std::string>* pruned =
+            get_pruned_definitions(module_);
+        w.u8(pruned ? 1 : 0);
+        if (pruned) {
+            w.varint(pruned->size());
+            for (const std::string& pruned_name : *pruned)
+                w.varint(intern_string(pruned_name));
+        }
+
+        ByteWriter header(out);
+        header.bytes(kMagic, 4);
+        header.varint(kVersion);
+        header.varint(keep_local_names_ ? 0 : kFlagNoLocalNames);
+        header.varint(strings_.size());
+        for (const std::string& s : strings_) {
+            header.varint(s.size());
+            header.bytes(s.data(), s.size());
+        }
+        header.varint(type_count_);
+        out.append(type_records_);
+        out.append(body);
+        return true;
+    }
+
+   private:
+    uint64_t intern_string(const std::string& s) {
+        if (s.empty()) return kNoName;
+        auto it = string_idx_.find(s);
+        if (it != string_idx_.end()) return it->second;
+        strings_.push_back(s);
+        string_idx_[s] = strings_.size();
+        return strings_.size();
+    }
+
+    uint64_t local_name(const std::string& s) {
+        return keep_local_names_ ? intern_string(s) : kNoName;
+    }
+
+    // 类型按依赖顺序写入类型表，元素类型总在前
+    uint64_t intern_type(midend::Type* type) {
+        auto it = type_idx_.find(type);
+        if (it != type_idx_.end()) return it->second;
+
+        std::string record;
+        ByteWriter w(record);
+        if (type->isVoidType()) {
+            w.u8(TYPE_VOID);
+        } else if (type->isIntegerType()) {
+            w.u8(TYPE_INT);
+            w.varint(type->getBitWidth());
+        } else if (type->isFloatType()) {
+            w.u8(TYPE_FLOAT);
+        } else if (type->isPointerType()) {
+            uint64_t elem = intern_type(
+                static_cast<midend::PointerType*>(type)->getElementType());
+            w.u8(TYPE_POINTER);
+            w.varint(elem);
+        } else if (type->isArrayType()) {
+            auto array_type = static_cast<midend::ArrayType*>(type);
+            uint64_t elem = intern_type(array_type->getElementType());
+            w.u8(TYPE_ARRAY);
+            w.varint(elem);
+            w.varint(array_type->getNumElements());
+        } else if (type->isFunctionType()) {
+            auto func_type = static_cast<midend::FunctionType*>(type);
+            std::vector<uint64_t> params;
+            uint64_t ret = intern_type(func_type->getReturnType());
+            for (midend::Type* param : func_type->getParamTypes())
+                params.push_back(intern_type(param));
+            w.u8(TYPE_FUNCTION);
+            w.varint(ret);
+            w.varint(params.size());
+            for (uint64_t param : params) w.varint(param);
+        } else {
+            w.u8(TYPE_VOID);
+        }
+
+        uint64_t idx = type_count_++;
+        type_idx_[type] = idx;
+        type_records_.append(record);
+        return idx;
+    }
+
+    bool write_value(ByteWriter& w, midend::Value* value) {
+        if (!value) {
+            w.u8(VALUE_NULL);
+            return true;
+        }
+        auto inst_it = inst_idx_.find(value);
+        if (inst_it != inst_idx_.end()) {
+            w.u8(VALUE_INST);
+            w.varint(inst_it->second);
+            return true;
+        }
+        auto arg_it = arg_idx_.find(value);
+        if (arg_it != arg_idx_.end()) {
+            w.u8(VALUE_ARG);
+            w.varint(arg_it->second);
+            return true;
+        }
+        if (auto global = dynamic_cast<midend::GlobalVariable*>(value)) {
+            w.u8(VALUE_GLOBAL);
+            w.varint(global_idx_[global]);
+            return true;
+        }
+        if (auto func = dynamic_cast<midend::Function*>(value)) {
+            w.u8(VALUE_FUNC);
+            w.varint(func_idx_[func]);
+            return true;
+        }
+        if (auto const_int = dynamic_cast<midend::ConstantInt*>(value)) {
+            w.u8(VALUE_CONST_INT);
+            w.varint(intern_type(const_int->getType()));
+            w.svarint((int32_t)const_int->getValue());
+            return true;
+        }
+        if (auto const_fp = dynamic_cast<midend::ConstantFP*>(value)) {
+            w.u8(VALUE_CONST_FP);
+            w.f32(const_fp->getValue());
+            return true;
+        }
+        if (auto const_array = dynamic_cast<midend::ConstantArray*>(value)) {
+            w.u8(VALUE_CONST_ARRAY);
+            w.varint(intern_type(const_array->getType()));
+            unsigned count = const_array->getNumOperands();
+            w.varint(count);
+            for (unsigned i = 0; i < count;) {
+                midend::Value* elem = const_array->getOperand(i);
+                unsigned run = 1;
+                while (i + run < count &&
+                       same_constant(elem, const_array->getOperand(i + run)))
+                    run++;
+                w.varint(run);
+                if (!write_value(w, elem)) return false;
+                i += run;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool write_block_ref(ByteWriter& w, midend::BasicBlock* block) {
+        auto it = block_idx_.find(block);
+        if (it == block_idx_.end()) return false;
+        w.varint(it->second);
+        return true;
+    }
+
+    bool write_function_body(ByteWriter& w, midend::Function* func) {
+        inst_idx_.clear();
+        arg_idx_.clear();
+        block_idx_.clear();
+
+        std::vector<midend::BasicBlock*> blocks;
+        for (auto block : *func) {
+            block_idx_[block] = blocks.size();
+            blocks.push_back(block);
+        }
+        w.varint(blocks.size());
+        if (blocks.empty()) return true;
+
+        for (size_t i = 0; i < func->getNumArgs(); i++)
+            arg_idx_[func->getArg(i)] = i;
+        // 先为所有指令编号，phi可能引用后续定义的值
+        uint64_t count = 0;
+        for (auto block : blocks)
+            for (auto inst : *block) inst_idx_[inst] = count++;
+
+        for (auto block : blocks) w.varint(local_name(block->getName()));
+        for (auto block : blocks) {
+            uint64_t inst_count = 0;
+            for (auto it = block->begin(); it != block->end(); ++it)
+                inst_count++;
+            w.varint(inst_count);
+            for (auto inst : *block) {
+                if (!write_instruction(w, inst)) return false;
+            }
+        }
+        return true;
+    }
+
+    bool write_block_refs(ByteWriter& w,
+                          const std::vector<midend::BasicBlock*>& blocks) {
+        w.varint(blocks.size());
+        for (auto block : blocks)
+            if (!write_block_ref(w, block)) return false;
+        return true;
+    }
+
+    // 函数的前端记录，紧接在函数体之后写出，引用刚编号的块与指令
+    bool write_function_annotations(ByteWriter& w, midend::Function* func) {
+        const FunctionAttributes* attributes =
+            get_function_attributes(module_, func);
+        w.u8(attributes ? 1 : 0);
+        if (attributes) {
+            w.u8((attributes->readnone ? 1 : 0) |
+                 (attributes->readonly ? 2 : 0) |
+                 (attributes->norecurse ? 4 : 0));
+            w.varint(attributes->params.size());
+            for (const ParamAttributes& param : attributes->params)
+                w.u8((param.noalias ? 1 : 0) | (param.readonly ? 2 : 0));
+        }
+
+        const StackEstimate* estimate = get_stack_estimate(module_, func);
+        w.u8(estimate ? 1 : 0);
+        if (estimate) {
+            w.varint(estimate->frame_bytes);
+            w.varint(estimate->largest_array_bytes);
+            w.varint(estimate->static_bytes);
+        }
+
+        const FunctionLoops* loops = get_loop_annotations(module_, func);
+        if (!loops) {
+            w.u8(0);
+            return true;
+        }
+        w.u8(1);
+        w.varint(loops->size());
+        for (const LoopAnnotation& loop : *loops) {
+            if (!write_block_ref(w, loop.header) ||
+                !write_block_refs(w, loop.blocks) ||
+                !write_block_refs(w, loop.latches))
+                return false;
+            w.u8(loop.exit ? 1 : 0);
+            if (loop.exit && !write_block_ref(w, loop.exit)) return false;
+            w.varint(loop.depth);
+            w.svarint(loop.parent);
+            if (!write_value(w, loop.induction)) return false;
+            w.svarint(loop.bound);
+            w.svarint(loop.trip_count);
+        }
+        return true;
+    }
+
+    bool write_instruction(ByteWriter& w, midend::Instruction* inst) {
+        OpKind op = classify_instruction(inst);
+        if (op == OP_UNKNOWN) return false;
+        w.u8(op);
+        w.varint(local_name(inst->getName()));
+
+        switch (op) {
+            case OP_ALLOCA:
+                w.varint(intern_type(static_cast<midend::AllocaInst*>(inst)
+                                         ->getAllocatedType()));
+                return true;
+            case OP_GEP: {
+                auto gep = static_cast<midend::GetElementPtrInst*>(inst);
+                w.varint(intern_type(gep->getSourceElementType()));
+                if (!write_value(w, gep->getPointerOperand())) return false;
+                w.varint(gep->getNumIndices());
+                for (unsigned i = 0; i < gep->getNumIndices(); i++) {
+                    if (!write_value(w, gep->getIndex(i))) return false;
+                }
+                return true;
+            }
+            case OP_CALL: {
+                auto call = static_cast<midend::CallInst*>(inst);
+                if (!write_value(w, call->getCalledFunction())) return false;
+                w.varint(call->getNumArgOperands());
+                for (unsigned i = 0; i < call->getNumArgOperands(); i++) {
+                    if (!write_value(w, call->getArgOperand(i))) return false;
+                }
+                return true;
+            }
+            case OP_RET: {
+                auto ret = static_cast<midend::ReturnInst*>(inst);
+                return write_value(w, ret->getReturnValue());
+            }
+            case OP_RET_VOID:
+                return true;
+            case OP_BR:
+                return write_block_ref(
+                    w, static_cast<midend::BranchInst*>(inst)->getSuccessor(0));
+            case OP_COND_BR: {
+                auto br = static_cast<midend::BranchInst*>(inst);
+                return write_value(w, br->getCondition()) &&
+                       write_block_ref(w, br->getSuccessor(0)) &&
+                       write_block_ref(w, br->getSuccessor(1));
+            }
+            case OP_PHI: {
+                auto phi = static_cast<midend::PHINode*>(inst);
+                w.varint(intern_type(phi->getType()));
+                w.varint(phi->getNumIncomingValues());
+                for (unsigned i = 0; i < phi->getNumIncomingValues(); i++) {
+                    if (!write_value(w, phi->getIncomingValue(i)) ||
+                        !write_block_ref(w, phi->getIncomingBlock(i)))
+                        return false;
+                }
+                return true;
+            }
+            default:
+                // load、store、一元/二元运算、比较与类型转换只需写出操作数
+                w.varint(inst->getNumOperands());
+                for (unsigned i = 0; i < inst->getNumOperands(); i++) {
+                    if (!write_value(w, inst->getOperand(i))) return false;
+                }
+                return true;
+        }
+    }
+
+    midend::Module* module_;
+    bool keep_local_names_;
+    std::vector<std::string> strings_;
+    std::unordered_map<std::string, uint64_t> string_idx_;
+    std::string type_records_;
+    uint64_t type_count_ = 0;
+    std::unordered_map<midend::Type*, uint64_t> type_idx_;
+    std::unordered_map<midend::GlobalVariable*, uint64_t> global_idx_;
+    std::unordered_map<midend::Function*, uint64_t> func_idx_;
+    std::unordered_map<midend::Value*, uint64_t> inst_idx_;
+    std::unordered_map<midend::Value*, uint64_t> arg_idx_;
+    std::unordered_map<midend::BasicBlock*, uint64_t> block_idx_;
+};
+
+class ModuleReader {
+   public:
+    ModuleReader(const char* data, size_t size) : r_(data, size) {}
+
+    std::unique_ptr<midend::Module> read() {
+        const char* magic = r_.bytes(4);
+        if (!magic || memcmp(magic, kMagic, 4) != 0) return nullptr;
+        if (r_.varint() != kVersion) return nullptr;
+        r_.varint();  // 标志位
+
+        ctx_ = new midend::Context();
+        auto module = std::make_unique<midend::Module>("main", ctx_);
+        module_ = module.get();
+        // 新模块可能与已释放的模块地址相同，不能沿用其记录
+        clear_module_annotations(module_);
+
+        bool ok = read_strings() && read_types() && read_globals() &&
+                  read_functions();
+        for (size_t i = 0; ok && i < funcs_.size(); i++)
+            ok = read_function_body(funcs_[i]) &&
+                 read_function_annotations(funcs_[i]);
+        if (ok) ok = read_pruned_definitions();
+        if (!ok || !r_.ok()) {
+            clear_module_annotations(module_);
+            return nullptr;
+        }
+        return module;
+    }
+
+   private:
+    const std::string& name(uint64_t idx) {
+        static const std::string empty;
+        if (idx == kNoName || idx > strings_.size()) return empty;
+        return strings_[idx - 1];
+    }
+
+    midend::Type* type(uint64_t idx) {
+        if (idx >= types_.size()) return nullptr;
+        return types_[idx];
+    }
+
+    bool read_pruned_definitions() {
+        if (!r_.u8()) return r_.ok();
+        uint64_t count = r_.varint();
+        std::vector<std::string> names;
+        for (uint64_t i = 0; i < count && r_.ok(); i++) {
+            uint64_t idx = r_.varint();
+            if (idx == kNoName || idx > strings_.size()) return false;
+            names.push_back(name(idx));
+        }
+        set_pruned_definitions(module_, std::move(names));
+        return r_.ok();
+    }
+
+    bool read_strings() {
+        uint64_t count = r_.varint();
+        for (uint64_t i = 0; i < count && r_.ok(); i++) {
+            uint64_t len = r_.varint();
+            const char* s = r_.bytes(len);
+            if (!s) return false;
+            strings_.emplace_back(s, len);
+        }
+        return r_.ok();
+    }
+
+    bool read_types() {
+        uint64_t count = r_.varint();
+        for (uint64_t i = 0; i < count && r_.ok(); i++) {
+            midend::Type* t = nullptr;
+            switch (r_.u8()) {
+                case TYPE_VOID:
+                    t = ctx_->getVoidType();
+                    break;
+                case TYPE_INT:
+                    switch (r_.varint()) {
+                        case 1:
+                            t = ctx_->getInt1Type();
+                            break;
+                        case 64:
+                            t = ctx_->getInt64Type();
+                            break;
+                        default:
+                            t = ctx_->getInt32Type();
+                            break;
+                    }
+                    break;
+                case TYPE_FLOAT:
+                    t = ctx_->getFloatType();
+                    break;
+                case TYPE_POINTER: {
+                    midend::Type* elem = type(r_.varint());
+                    if (elem) t = midend::PointerType::get(elem);
+                    break;
+                }
+                case TYPE_ARRAY: {
+                    midend::Type* elem = type(r_.varint());
+                    uint64_t n = r_.varint();
+                    if (elem) t = midend::ArrayType::get(elem, n);
+                    break;
+                }
+                case TYPE_FUNCTION: {
+                    midend::Type* ret = type(r_.varint());
+                    std::vector<midend::Type*> params;
+                    uint64_t param_count = r_.varint();
+                    for (uint64_t j = 0; j < param_count && r_.ok(); j++) {
+                        midend::Type* param = type(r_.varint());
+                        if (!param) return false;
+                        params.push_back(param);
+                    }
+                    if (ret) t = midend::FunctionType::get(ret, params);
+                    break;
+                }
+                default:
+                    return false;
+            }
+            if (!t) return false;
+            types_.push_back(t);
+        }
+        return r_.ok();
+    }
+
+    bool read_globals() {
+        uint64_t count = r_.varint();
+        for (uint64_t i = 0; i < count && r_.ok(); i++) {
+            const std::string& global_name = name(r_.varint());
+            midend::Type* value_type = type(r_.varint());
+            bool is_const = r_.u8();
+            auto linkage = r_.u8() ? midend::GlobalVariable::InternalLinkage
+                                   : midend::GlobalVariable::ExternalLinkage;
+            midend::Constant* init = nullptr;
+            if (r_.u8()) {
+                init = dynamic_cast<midend::Constant*>(read_value(nullptr));
+                if (!init) return false;
+            }
+            if (!value_type) return false;
+            globals_.push_back(midend::GlobalVariable::Create(
+                value_type, is_const, linkage, init, global_name, module_));
+        }
+        return r_.ok();
+    }
+
+    bool read_functions() {
+        uint64_t count = r_.varint();
+        for (uint64_t i = 0; i < count && r_.ok(); i++) {
+            const std::string& func_name = name(r_.varint());
+            auto func_type =
+                static_cast<midend::FunctionType*>(type(r_.varint()));
+            if (!func_type) return false;
+            std::vector<std::string> arg_names;
+            uint64_t arg_count = r_.varint();
+            for (uint64_t j = 0; j < arg_count && r_.ok(); j++)
+                arg_names.push_back(name(r_.varint()));
+            funcs_.push_back(midend::Function::Create(func_type, func_name,
+                                                      arg_names, module_));
+        }
+        return r_.ok();
+    }
+
+    // 读取值引用，尚未定义的指令返回nullptr并记录forward
+    midend::Value* read_value(midend::Function* func, bool* forward = nullptr) {
+        uint8_t tag = r_.u8();
+        switch (tag) {
+            case VALUE_NULL:
+                return nullptr;
+            case VALUE_INST: {
+                uint64_t idx = r_.varint();
+                if (idx < insts_.size() && insts_[idx]) return insts_[idx];
+                if (forward) {
+                    *forward = true;
+                    pending_idx_ = idx;
+                }
+                return nullptr;
+            }
+            case VALUE_ARG: {
+                uint64_t idx = r_.varint();
+                if (!func || idx >= func->getNumArgs()) return nullptr;
+                return func->getArg(idx);
+            }
+            case VALUE_GLOBAL: {
+                uint64_t idx = r_.varint();
+                return idx < globals_.size() ? globals_[idx] : nullptr;
+            }
+            case VALUE_FUNC: {
+                uint64_t idx = r_.varint();
+                return idx < funcs_.size() ? funcs_[idx] : nullptr;
+            }
+            case VALUE_CONST_INT: {
+                auto int_type =
+                    static_cast<midend::IntegerType*>(type(r_.varint()));
+                int64_t v = r_.svarint();
+                if (!int_type) return nullptr;
+                return midend::ConstantInt::get(int_type, v);
+            }
+            case VALUE_CONST_FP:
+                return midend::ConstantFP::get(ctx_->getFloatType(), r_.f32());
+            case VALUE_CONST_ARRAY: {
+                auto array_type =
+                    static_cast<midend::ArrayType*>(type(r_.varint()));
+                uint64_t count = r_.varint();
+                std::vector<midend::Constant*> elements;
+                while (elements.size() < count && r_.ok()) {
+                    uint64_t run = r_.varint();
+                    if (run == 0 || run > count - elements.size())
+                        return nullptr;
+                    auto elem =
+                        dynamic_cast<midend::Constant*>(read_value(func));
+                    if (!elem) return nullptr;
+                    elements.insert(elements.end(), run, elem);
+                }
+                if (!array_type) return nullptr;
+                return midend::ConstantArray::get(array_type, elements);
+            }
+            default:
+                r_.varint();
+                return nullptr;
+        }
+    }
+
+    midend::BasicBlock* read_block_ref() {
+        uint64_t idx = r_.varint();
+        return idx < blocks_.size() ? blocks_[idx] : nullptr;
+    }
+
+    bool read_function_body(midend::Function* func) {
+        insts_.clear();
+        blocks_.clear();
+        pending_phis_.clear();
+        uint64_t block_count = r_.varint();
+        if (block_count == 0) return r_.ok();
+
+        for (uint64_t i = 0; i < block_count && r_.ok(); i++) {
+            blocks_.push_back(
+                midend::BasicBlock::Create(ctx_, name(r_.varint()), func));
+        }
+
+        midend::IRBuilder builder(blocks_[0]);
+        for (uint64_t i = 0; i < block_count && r_.ok(); i++) {
+            builder.setInsertPoint(blocks_[i]);
+            uint64_t inst_count = r_.varint();
+            for (uint64_t j = 0; j < inst_count && r_.ok(); j++) {
+                midend::Value* inst = read_instruction(builder, func);
+                if (!inst) return false;
+                insts_.push_back(inst);
+            }
+        }
+
+        // phi的入边在所有指令建立后补齐
+        for (auto& pending : pending_phis_) {
+            if (pending.value_idx >= insts_.size()) return false;
+            pending.phi->addIncoming(insts_[pending.value_idx], pending.block);
+        }
+        return r_.ok();
+    }
+
+    bool read_block_refs(std::vector<midend::BasicBlock*>& blocks) {
+        uint64_t count = r_.varint();
+        for (uint64_t i = 0; i < count && r_.ok(); i++) {
+            midend::BasicBlock* block = read_block_ref();
+            if (!block) return false;
+            blocks.push_back(block);
+        }
+        return r_.ok();
+    }
+
+    // 读取函数体之后的前端记录并登记到模块上
+    bool read_function_annotations(midend::Function* func) {
+        if (r_.u8()) {
+            FunctionAttributes attributes;
+            uint8_t flags = r_.u8();
+            attributes.readnone = flags & 1;
+            attributes.readonly = flags & 2;
+            attributes.norecurse = flags & 4;
+            uint64_t param_count = r_.varint();
+            if (param_count > func->getNumArgs()) return false;
+            for (uint64_t i = 0; i < param_count && r_.ok(); i++) {
+                ParamAttributes param;
+                uint8_t param_flags = r_.u8();
+                param.noalias = param_flags & 1;
+                param.readonly = param_flags & 2;
+                attributes.params.push_back(param);
+            }
+            if (!r_.ok()) return false;
+            set_function_attributes(module_, func, std::move(attributes));
+        }
+
+        if (r_.u8()) {
+            StackEstimate estimate;
+            estimate.frame_bytes = (int64_t)r_.varint();
+            estimate.largest_array_bytes = (int64_t)r_.varint();
+            estimate.static_bytes = (int64_t)r_.varint();
+            if (!r_.ok()) return false;
+            set_stack_estimate(module_, func, estimate);
+        }
+
+        if (!r_.u8()) return r_.ok();
+        FunctionLoops loops;
+        uint64_t count = r_.varint();
+        for (uint64_t i = 0; i < count && r_.ok(); i++) {
+            LoopAnnotation loop;
+            loop.header = read_block_ref();
+            if (!loop.header || !read_block_refs(loop.blocks) ||
+                !read_block_refs(loop.latches))
+                return false;
+            if (r_.u8()) {
+                loop.exit = read_block_ref();
+                if (!loop.exit) return false;
+            }
+            loop.depth = (int)r_.varint();
+            loop.parent = (int)r_.svarint();
+            loop.induction = read_operand(func);
+            loop.bound = (int)r_.svarint();
+            loop.trip_count = r_.svarint();
+            loops.push_back(std::move(loop));
+        }
+        if (!r_.ok()) return false;
+        set_loop_annotations(module_, func, std::move(loops));
+        return true;
+    }
+
+    midend::Value* read_operand(midend::Function* func) {
+        bool forward = false;
+        midend::Value* v = read_value(func, &forward);
+        // 除phi外不允许前向引用
+        if (forward) return nullptr;
+        return v;
+    }
+
+    midend::Value* read_instruction(midend::IRBuilder& builder,
+                                    midend::Function* func) {
+        OpKind op = (OpKind)r_.u8();
+        const std::string& inst_name = name(r_.varint());
+
+        switch (op) {
+            case OP_ALLOCA: {
+                midend::Type* alloca_type = type(r_.varint());
+                if (!alloca_type) return nullptr;
+                return builder.createAlloca(alloca_type, nullptr, inst_name);
+            }
+            case OP_GEP: {
+                midend::Type* source_type = type(r_.varint());
+                midend::Value* ptr = read_operand(func);
+                std::vector<midend::Value*> indices;
+                uint64_t index_count = r_.varint();
+                for (uint64_t i = 0; i < index_count && r_.ok(); i++) {
+                    midend::Value* index = read_operand(func);
+                    if (!index) return nullptr;
+                    indices.push_back(index);
+                }
+                if (!source_type || !ptr) return nullptr;
+                return builder.createGEP(source_type, ptr, indices, inst_name);
+            }
+            case OP_CALL: {
+                auto callee = dynamic_cast<midend::Function*>(read_value(func));
+                std::vector<midend::Value*> args;
+                uint64_t arg_count = r_.varint();
+                for (uint64_t i = 0; i < arg_count && r_.ok(); i++) {
+                    midend::Value* arg = read_operand(func);
+                    if (!arg) return nullptr;
+                    args.push_back(arg);
+                }
+                if (!callee) return nullptr;
+                return builder.createCall(callee, args, inst_name);
+            }
+            case OP_RET: {
+                midend::Value* v = read_operand(func);
+                return v ? builder.createRet(v) : nullptr;
+            }
+            case OP_RET_VOID:
+                return builder.createRetVoid();
+            case OP_BR: {
+                midend::BasicBlock* dest = read_block_ref();
+                return dest ? builder.createBr(dest) : nullptr;
+            }
+            case OP_COND_BR: {
+                midend::Value* cond = read_operand(func);
+                midend::BasicBlock* then_dest = read_block_ref();
+                midend::BasicBlock* else_dest = read_block_ref();
+                if (!cond || !then_dest || !else_dest) return nullptr;
+                return builder.createCondBr(cond, then_dest, else_dest);
+            }
+            case OP_PHI: {
+                midend::Type* phi_type = type(r_.varint());
+                if (!phi_type) return nullptr;
+                midend::PHINode* phi = builder.createPHI(phi_type, inst_name);
+                uint64_t incoming_count = r_.varint();
+                for (uint64_t i = 0; i < incoming_count && r_.ok(); i++) {
+                    bool forward = false;
+                    midend::Value* v = read_value(func, &forward);
+                    midend::BasicBlock* block = read_block_ref();
+                    if (!block) return nullptr;
+                    if (forward)
+                        pending_phis_.push_back({phi, pending_idx_, block});
+                    else if (v)
+                        phi->addIncoming(v, block);
+                    else
+                        return nullptr;
+                }
+                return phi;
+            }
+            default:
+                break;
+        }
+
+        // 其余指令：读取操作数
+        std::vector<midend::Value*> ops;
+        uint64_t op_count = r_.varint();
+        for (uint64_t i = 0; i < op_count && r_.ok(); i++) {
+            midend::Value* v = read_operand(func);
+            if (!v) return nullptr;
+            ops.push_back(v);
+        }
+
+        switch (op) {
+            case OP_LOAD:
+                if (ops.size() != 1) return nullptr;
+                return builder.createLoad(ops[0], inst_name);
+            case OP_STORE:
+                if (ops.size() != 2) return nullptr;
+                return builder.createStore(ops[0], ops[1]);
+            case OP_USUB:
+                if (ops.size() != 1) return nullptr;
+                return builder.createUSub(ops[0], inst_name);
+            case OP_SITOFP:
+                if (ops.size() != 1) return nullptr;
+                return builder.createCast(midend::CastInst::CastOps::SIToFP,
+                                          ops[0], ctx_->getFloatType(),
+                                          inst_name);
+            case OP_FPTOSI:
+                if (ops.size() != 1) return nullptr;
+                return builder.createCast(midend::CastInst::CastOps::FPToSI,
+                                          ops[0], ctx_->getInt32Type(),
+                                          inst_name);
+            default:
+                break;
+        }
+
+        if (ops.size() != 2) return nullptr;
+        midend::Value *lhs = ops[0], *rhs = ops[1];
+        switch (op) {
+            case OP_ADD:
+                return builder.createAdd(lhs, rhs, inst_name);
+            case OP_SUB:
+                return builder.createSub(lhs, rhs, inst_name);
+            case OP_MUL:
+                return builder.createMul(lhs, rhs, inst_name);
+            case OP_DIV:
+                return builder.createDiv(lhs, rhs, inst_name);
+            case OP_REM:
+                return builder.createRem(lhs, rhs, inst_name);
+            case OP_FADD:
+                return builder.createFAdd(lhs, rhs, inst_name);
+            case OP_FSUB:
+                return builder.createFSub(lhs, rhs, inst_name);
+            case OP_FMUL:
+                return builder.createFMul(lhs, rhs, inst_name);
+            case OP_FDIV:
+                return builder.createFDiv(lhs, rhs, inst_name);
+            case OP_ICMP_EQ:
+                return builder.createICmpEQ(lhs, rhs, inst_name);
+            case OP_ICMP_NE:
+                return builder.createICmpNE(lhs, rhs, inst_name);
+            case OP_ICMP_SLT:
+                return builder.createICmpSLT(lhs, rhs, inst_name);
+            case OP_ICMP_SLE:
+                return builder.createICmpSLE(lhs, rhs, inst_name);
+            case OP_ICMP_SGT:
+                return builder.createICmpSGT(lhs, rhs, inst_name);
+            case OP_ICMP_SGE:
+                return builder.createICmpSGE(lhs, rhs, inst_name);
+            case OP_FCMP_OEQ:
+                return builder.createFCmpOEQ(lhs, rhs, inst_name);
+            case OP_FCMP_ONE:
+                return builder.createFCmpONE(lhs, rhs, inst_name);
+            case OP_FCMP_OLT:
+                return builder.createFCmpOLT(lhs, rhs, inst_name);
+            case OP_FCMP_OLE:
+                return builder.createFCmpOLE(lhs, rhs, inst_name);
+            case OP_FCMP_OGT:
+                return builder.createFCmpOGT(lhs, rhs, inst_name);
+            case OP_FCMP_OGE:
+                return builder.createFCmpOGE(lhs, rhs, inst_name);
+            default:
+                return nullptr;
+        }
+    }
+
+    struct PendingIncoming {
+        midend::PHINode* phi;
+        uint64_t value_idx;
+        midend::BasicBlock* block;
+    };
+
+    ByteReader r_;
+    midend::Context* ctx_ = nullptr;
+    midend::Module* module_ = nullptr;
+    std::vector<std::string> strings_;
+    std::vector<midend::Type*> types_;
+    std::vector<midend::GlobalVariable*> globals_;
+    std::vector<midend::Function*> funcs_;
+    std::vector<midend::Value*> insts_;
+    std::vector<midend::BasicBlock*> blocks_;
+    std::vector<PendingIncoming> pending_phis_;
+    uint64_t pending_idx_ = 0;
+};
+
+}  // namespace
+
+bool write_module_binary(midend::Module* module, std::string& out,
+                         bool keep_local_names) {
+    if (!module) return false;
+    ModuleWriter writer(module, keep_local_names);
+    return writer.write(out);
+}
+
+std::unique_ptr<midend::Module> read_module_binary(const char* data,
+                                                   size_t size) {
+    if (!data) return nullptr;
+    ModuleReader reader(data, size);
+    return reader.read();
+}
+
+bool write_module_binary_file(midend::Module* module, const char* path,
+                              bool keep_local_names) {
+    std::string data;
+    if (!write_module_binary(module, data, keep_local_names)) return false;
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return (fclose(file) == 0) && ok;
+}
+
+std::unique_ptr<midend::Module> read_module_binary_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return nullptr;
+    std::string data;
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) data.append(buf, n);
+    bool ok = !ferror(file);
+    fclose(file);
+    if (!ok) return nullptr;
+    return read_module_binary(data.data(), data.size());
+}
@@ -0,0 +1,201 @@
+#include "parallel_parse.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "sy_parser/parse.h"
+#include "sy_parser/prescan.h"
+#include "sy_parser/symbol_table.h"
+}
+
+namespace {
+
+// 一个函数体的并行解析
+struct BodyParse {
+    ASTNodePtr func_def;  // 骨架中的函数定义，children[1]为占位的空块
+    size_t begin;         // 函数体的'{'
+    size_t end;           // '}'之后
+    int lines;            // 扫描器在函数体内计入的换行数
+    ASTNodePtr block = nullptr;
+    BodySymbols symbols = {nullptr, nullptr, 0};
+    bool ok = false;
+};
+
+// 扫描器计入行号的换行：注释中的计入，字符串常量中的不计入。与扫描器不一致
+// 时函数体解析结束的行号对不上，会改为串行解析
+int count_lines(const char* src, size_t begin, size_t end) {
+    int lines = 0;
+    for (size_t pos = begin; pos < end; pos++) {
+        char c = src[pos];
+        if (c == '\n') {
+            lines++;
+        } else if (c == '/' && pos + 1 < end && src[pos + 1] == '/') {
+            while (pos + 1 < end && src[pos + 1] != '\n') pos++;
+        } else if (c == '/' && pos + 1 < end && src[pos + 1] == '*') {
+            pos += 2;
+            while (pos + 1 < end && !(src[pos] == '*' && src[pos + 1] == '/')) {
+                if (src[pos] == '\n') lines++;
+                pos++;
+            }
+            pos++;
+        } else if (c == '"') {
+            while (pos + 1 < end && src[pos + 1] != '"') {
+                if (src[pos + 1] == '\\') pos++;
+                pos++;
+            }
+            pos++;
+        }
+    }
+    return lines;
+}
+
+// 函数体替换为同一行的"{}"，其中的换行移到'}'之后，其余位置的行号不变
+std::string make_skeleton(const std::string& source,
+                          const std::vector<BodyParse>& bodies) {
+    std::string skeleton;
+    size_t copied = 0;
+    for (const auto& body : bodies) {
+        skeleton.append(source, copied, body.begin + 1 - copied);
+        skeleton += '}';
+        skeleton.append(body.lines, '\n');
+        copied = body.end;
+    }
+    skeleton.append(source, copied, std::string::npos);
+    return skeleton;
+}
+
+void free_body_symbols(BodySymbols& symbols) {
+    for (int i = 0; i < symbols.symb_count; i++) {
+        free(symbols.symbols[i]->name);
+        free(symbols.symbols[i]);
+    }
+    free(symbols.symbols);
+    symbols.symbols = nullptr;
+    symbols.symb_count = 0;
+}
+
+// 在工作线程上解析各函数体，全部成功时返回true
+bool parse_bodies(const std::string& source, std::vector<BodyParse>& bodies,
+                  int threads, std::vector<GlobalCounts>& counts) {
+    Scope* global_scope = get_global_scope();
+    int global_count = get_symbol_count();
+    std::atomic<size_t> next_body(0);
+    std::atomic<bool> failed(false);
+
+    auto worker = [&](int index) {
+        begin_worker_symbols(global_scope, global_count);
+        for (size_t i; !failed && (i = next_body++) < bodies.size();) {
+            BodyParse& body = bodies[i];
+            int lineno = body.func_def->children[1]->lineno;
+            int end_lineno = 0;
+            set_speculative_parse(true);
+            enter_function_body(body.func_def->data.symb_ptr);
+            int parse_result = parse_function_body(
+                source.data() + body.begin, body.end - body.begin, lineno,
+                &body.block, &end_lineno);
+            body.ok = !parse_result && body.block &&
+                      !speculative_parse_failed() &&
+                      end_lineno == lineno + body.lines;
+            body.symbols = exit_function_body();
+            if (!body.ok) failed = true;
+        }
+        set_speculative_parse(false);
+        counts[index] = end_worker_symbols();
+    };
+
+    counts.resize(threads);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(worker, t);
+    for (auto& thread : pool) thread.join();
+    return !failed;
+}
+
+}  // namespace
+
+int parse_source(const std::string& source, int threads, ASTNodePtr* result,
+                 ParallelParseStats* stats) {
+    if (stats) *stats = {0, true};
+    *result = nullptr;
+
+    TopLevelUnits units;
+    if (threads <= 1 ||
+        prescan_top_level(source.data(), source.size(), &units) != 0)
+        return parse_buffer(source.data(), source.size(), result);
+
+    std::vector<BodyParse> bodies;
+    for (int i = 0; i < units.unit_count; i++) {
+        const TopLevelUnit& unit = units.units[i];
+        if (unit.kind != UNIT_FUNC) continue;
+        BodyParse body;
+        body.func_def = nullptr;
+        body.begin = unit.body_begin;
+        body.end = unit.end;
+        body.lines = count_lines(source.data(), unit.body_begin + 1,
+                                 unit.end - 1);
+        bodies.push_back(body);
+    }
+    free_top_level_units(&units);
+    if (bodies.size() < 2)
+        return parse_buffer(source.data(), source.size(), result);
+
+    // 全局声明与函数签名：串行解析骨架
+    std::string skeleton = make_skeleton(source, bodies);
+    SymbolTableMark mark = mark_symbol_table();
+    ASTNodePtr program = nullptr;
+    set_speculative_parse(true);
+    bool ok = !parse_buffer(skeleton.data(), skeleton.size(), &program) &&
+              program && !speculative_parse_failed();
+    set_speculative_parse(false);
+
+    // 骨架中的函数定义与预扫描找到的函数体按顺序一一对应
+    if (ok) {
+        size_t next = 0;
+        for (int i = 0; ok && i < program->child_count; i++) {
+            ASTNodePtr child = program->children[i];
+            if (child->node_type != NODE_FUNC_DEF) continue;
+            ok = next < bodies.size() && child->child_count == 2 &&
+                 child->data.symb_ptr;
+            if (ok) bodies[next++].func_def = child;
+        }
+        ok = ok && next == bodies.size();
+    }
+
+    std::vector<GlobalCounts> counts;
+    if (ok) {
+        int pool_size = std::min<int>(threads, bodies.size());
+        ok = parse_bodies(source, bodies, pool_size, counts);
+    }
+
+    if (!ok) {
+        for (auto& body : bodies) {
+            if (body.block) free_ast(body.block);
+            free_body_symbols(body.symbols);
+        }
+        for (auto& count : counts) {
+            free(count.ref_counts);
+            free(count.call_counts);
+        }
+        if (program) free_ast(program);
+        reset_symbol_table(&mark);
+        return parse_buffer(source.data(), source.size(), result);
+    }
+
+    // 合并：函数体替换占位的空块，符号并入符号表并重新编号
+    std::vector<BodySymbols> symbols;
+    for (auto& body : bodies) {
+        free_ast(body.func_def->children[1]);
+        body.func_def->children[1] = body.block;
+        symbols.push_back(body.symbols);
+    }
+    merge_body_symbols(symbols.data(), (int)symbols.size(), counts.data(),
+                       (int)counts.size());
+    free_symbol_table_mark(&mark);
+
+    *result = program;
+    if (stats) *stats = {(int)bodies.size(), false};
+    return 0;
+}
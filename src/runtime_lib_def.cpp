@@ -175,6 +175,19 @@ void add_runtime_lib_to_symbol_table() {
     func_name_to_ptr["stoptime"] = sym;
 }
 
+void bind_runtime_lib_symbols() {
+    // 运行库函数在解析前定义，行号为0
+    func_name_to_ptr.clear();
+    for (int id = 0;; id++) {
+        SymbolPtr sym = get_symbol_by_id(id);
+        if (!sym) break;
+        if (sym->symbol_type == SYMB_FUNCTION &&
+            sym->scope_level == GLOBAL_SCOPE_LEVEL &&
+            sym->lineno == 0)
+            func_name_to_ptr[sym->name] = sym;
+    }
+}
+
 void add_runtime_lib_to_func_tab(midend::Module* module) {
     if (func_name_to_ptr.empty()) return;
     auto ctx = module->getContext();
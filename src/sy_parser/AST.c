@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sy_parser/symbol_table.h"
 #include "sy_parser/utils.h"
@@ -80,12 +81,153 @@ void free_ast(ASTNodePtr node) {
     for (int i = 0; i < node->child_count; i++) {
         free_ast(node->children[i]);
     }
+    if (node->data_type == NODEDATA_PACKED && node->data.packed) {
+        free(node->data.packed->values.ints);
+        free(node->data.packed->expr_offsets);
+        free(node->data.packed);
+    }
     free(node->children);
     free(node->name);
     // Note: Does not free symb_ptr, as that is owned by the symbol table.
     free(node);
 }
 
+int packed_init_min = 1024;
+
+bool simplify_exps = false;
+
+int count_initer_elements(ASTNodePtr initer) {
+    if (!initer) return 0;
+    if (initer->node_type != NODE_LIST) return 1;
+    int count = 0;
+    for (int i = 0; i < initer->child_count; i++)
+        count += count_initer_elements(initer->children[i]);
+    return count;
+}
+
+// Store a constant at offset, growing the buffer to cover it
+static void packed_set_const(PackedInitPtr packed, int offset,
+                             ASTNodePtr node) {
+    if (offset >= packed->capacity) {
+        int capacity = packed->capacity ? packed->capacity : 64;
+        while (capacity <= offset) capacity *= 2;
+        packed->values.ints = (int*)realloc(packed->values.ints,
+                                            sizeof(int) * (size_t)capacity);
+        if (!packed->values.ints) {
+            fprintf(stderr, "Memory allocation failed for PackedInit\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(packed->values.ints + packed->capacity, 0,
+               sizeof(int) * (size_t)(capacity - packed->capacity));
+        packed->capacity = capacity;
+    }
+    if (packed->elem_type == DATA_FLOAT)
+        packed->values.floats[offset] = node->data_type == NODEDATA_FLOAT
+                                            ? node->data.direct_float
+                                            : (float)node->data.direct_int;
+    else
+        packed->values.ints[offset] = node->data_type == NODEDATA_FLOAT
+                                          ? (int)node->data.direct_float
+                                          : node->data.direct_int;
+    if (offset >= packed->length) packed->length = offset + 1;
+}
+
+// Walk one brace level. A nested list is aligned to the next sub-array
+// boundary and takes the whole sub-array; scalars fill consecutive slots.
+// Non-constant elements are moved to output's children, or only counted if
+// output is NULL. Returns the number of non-constant elements.
+static int pack_initer_level(ASTNodePtr list, PackedInitPtr packed,
+                             ASTNodePtr output, int dim, int dimensions,
+                             const int* sub_size, int elem_num, int* pos) {
+    int exprs = 0;
+    for (int i = 0; i < list->child_count; i++) {
+        ASTNodePtr child = list->children[i];
+        if (!child) continue;
+        if (child->node_type == NODE_LIST) {
+            if (dim >= dimensions - 1) continue;
+            int size = sub_size[dim + 1];
+            if (*pos % size) *pos = (*pos / size + 1) * size;
+            int start = *pos;
+            exprs += pack_initer_level(child, packed, output, dim + 1,
+                                       dimensions, sub_size, elem_num, pos);
+            *pos = start + size;
+        } else if (*pos < elem_num) {
+            if (child->node_type == NODE_CONST &&
+                (child->data_type == NODEDATA_INT ||
+                 child->data_type == NODEDATA_FLOAT)) {
+                packed_set_const(packed, *pos, child);
+            } else {
+                exprs++;
+                if (output) {
+                    packed->expr_offsets = (int*)realloc(
+                        packed->expr_offsets,
+                        sizeof(int) * (size_t)(output->child_count + 1));
+                    packed->expr_offsets[output->child_count] = *pos;
+                    add_child(output, child);
+                    list->children[i] = NULL;
+                }
+            }
+            (*pos)++;
+        }
+    }
+    return exprs;
+}
+
+// sub_size[d] is the number of elements in one sub-array at level d
+static int* initer_sub_sizes(int dimensions, const int* shape) {
+    int* sub_size = (int*)malloc(sizeof(int) * (size_t)(dimensions + 1));
+    sub_size[dimensions] = 1;
+    for (int d = dimensions - 1; d >= 0; d--)
+        sub_size[d] = sub_size[d + 1] * (shape[d] ? shape[d] : 1);
+    return sub_size;
+}
+
+ASTNodePtr pack_initer(ASTNodePtr initer, DataType elem_type, int dimensions,
+                       const int* shape, int elem_num) {
+    if (!initer || dimensions <= 0) return initer;
+
+    int* sub_size = initer_sub_sizes(dimensions, shape);
+
+    NodeData data;
+    data.packed = (PackedInitPtr)calloc(1, sizeof(PackedInit));
+    data.packed->elem_type = elem_type;
+    ASTNodePtr output =
+        create_ast_node(NODE_PACKED_INIT, initer->name, initer->lineno, 0);
+    set_ast_node_data(output, HOLD_NODETYPE, NULL, data, NODEDATA_PACKED, -1);
+
+    int pos = 0;
+    pack_initer_level(initer, data.packed, output, 0, dimensions, sub_size,
+                      elem_num, &pos);
+    free(sub_size);
+    free_ast(initer);
+    return output;
+}
+
+bool store_const_values(ASTNodePtr initer, DataType elem_type,
+                        ArrayInfo* array_info) {
+    if (!initer || array_info->dimensions <= 0) return false;
+
+    int* sub_size =
+        initer_sub_sizes(array_info->dimensions, array_info->shape);
+    PackedInit packed;
+    memset(&packed, 0, sizeof(packed));
+    packed.elem_type = elem_type;
+    int pos = 0;
+    int exprs =
+        pack_initer_level(initer, &packed, NULL, 0, array_info->dimensions,
+                          sub_size, array_info->elem_num, &pos);
+    free(sub_size);
+    if (exprs) {
+        free(packed.values.ints);
+        return false;
+    }
+    // An all-zero initializer needs no buffer, but values must be non-NULL
+    if (!packed.values.ints) packed.values.ints = (int*)malloc(sizeof(int));
+    array_info->values.ints = packed.values.ints;
+    array_info->value_count = packed.length;
+    return true;
+}
+
 const char* node_type_to_string(NodeType type) {
     switch (type) {
         case NODE_ROOT:
@@ -108,6 +250,8 @@ const char* node_type_to_string(NodeType type) {
             return "ARRAY_INIT_LIST";
         case NODE_CONST_ARRAY_INIT_LIST:
             return "CONST_ARRAY_INIT_LIST";
+        case NODE_PACKED_INIT:
+            return "PACKED_INIT";
         case NODE_FUNC_DEF:
             return "FUNC_DEF";
         case NODE_ASSIGN_STMT:
@@ -181,6 +325,10 @@ void print_ast(ASTNodePtr node, int level) {
         case NODEDATA_TYPE:
             printf(" (type: %s)", data_type_to_string(node->data.data_type));
             break;
+        case NODEDATA_PACKED:
+            printf(" (packed: %d values, %d exprs)", node->data.packed->length,
+                   node->child_count);
+            break;
         default:
             break;
     }
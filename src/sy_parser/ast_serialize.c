@@ -0,0 +1,616 @@
+#include "sy_parser/ast_serialize.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sy_parser/symbol_table.h"
+#include "sy_parser/utils.h"
+
+#define SERIAL_MAGIC "SYAS"
+#define SERIAL_VERSION 4
+#define SERIAL_BYTE_ORDER 0x01020304u
+
+// Image layout: header, symbols, nodes, child indices, int pool, strings.
+// Every section starts at an offset recorded in the header.
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    int32_t root;  // Node index of the root
+    uint32_t symbol_count, symbol_offset;
+    uint32_t node_count, node_offset;
+    uint32_t child_count, child_offset;
+    uint32_t int_count, int_offset;
+    uint32_t string_size, string_offset;
+} SerialHeader;
+
+// Symbol record; pointers become symbol ids, int pool indices or string
+// offsets, -1 stands for NULL
+typedef struct {
+    int32_t name;
+    int32_t function;
+    int32_t symbol_type;
+    int32_t data_type;
+    int32_t lineno;
+    int32_t scope_level;
+    int32_t ref_count;
+    // Attributes, meaning depends on symbol_type:
+    //   const: int_value, float bits
+    //   array: shape (int pool), dimensions, elem_num, const values (int
+    //          pool, float bits for float arrays), value_count
+    //   function: params (int pool), param_count, vars (int pool),
+    //             var_count, call_count
+    int32_t attr[5];
+} SerialSymbol;
+
+// Node record; children are stored in the child section
+typedef struct {
+    int32_t node_type;
+    int32_t name;
+    int32_t lineno;
+    int32_t data_type;
+    // Symbol id, int, float bits, string offset, DataType, or for a packed
+    // initializer the int pool index of: elem_type, length, length values,
+    // then one expression offset per child
+    int32_t data;
+    int32_t first_child;
+    int32_t child_count;
+} SerialNode;
+
+// --- Writer ---
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+static size_t buffer_append(Buffer* buf, const void* data, size_t size) {
+    size_t offset = buf->size;
+    if (buf->size + size > buf->capacity) {
+        size_t capacity = buf->capacity ? buf->capacity : 256;
+        while (capacity < buf->size + size) capacity *= 2;
+        buf->data = (char*)realloc(buf->data, capacity);
+        if (!buf->data) {
+            fprintf(stderr, "Memory reallocation failed for AST image\n");
+            exit(EXIT_FAILURE);
+        }
+        buf->capacity = capacity;
+    }
+    if (data) memcpy(buf->data + buf->size, data, size);
+    buf->size += size;
+    return offset;
+}
+
+typedef struct {
+    Buffer nodes;
+    Buffer children;
+    Buffer ints;
+    Buffer strings;
+    int node_count;
+} Writer;
+
+static int32_t write_string(Writer* w, const char* str) {
+    if (!str) return -1;
+    return (int32_t)buffer_append(&w->strings, str, strlen(str) + 1);
+}
+
+static int32_t write_ints(Writer* w, const int32_t* values, int count) {
+    int32_t index = (int32_t)(w->ints.size / sizeof(int32_t));
+    buffer_append(&w->ints, values, count * sizeof(int32_t));
+    return index;
+}
+
+static int32_t write_symbol_ids(Writer* w, SymbolPtr* symbols, int count) {
+    if (!symbols || count <= 0) return -1;
+    int32_t index = (int32_t)(w->ints.size / sizeof(int32_t));
+    for (int i = 0; i < count; i++) {
+        int32_t id = symbols[i] ? symbols[i]->id : -1;
+        buffer_append(&w->ints, &id, sizeof(id));
+    }
+    return index;
+}
+
+static void write_symbol(Writer* w, Buffer* out, SymbolPtr sym) {
+    SerialSymbol rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.name = write_string(w, sym->name);
+    rec.function = sym->function ? sym->function->id : -1;
+    rec.symbol_type = sym->symbol_type;
+    rec.data_type = sym->data_type;
+    rec.lineno = sym->lineno;
+    rec.scope_level = sym->scope_level;
+    rec.ref_count = sym->ref_count;
+
+    switch (sym->symbol_type) {
+        case SYMB_CONST_VAR:
+            rec.attr[0] = sym->attributes.const_info.int_value;
+            memcpy(&rec.attr[1], &sym->attributes.const_info.float_value,
+                   sizeof(float));
+            break;
+        case SYMB_ARRAY:
+        case SYMB_CONST_ARRAY: {
+            ArrayInfo* info = &sym->attributes.array_info;
+            rec.attr[0] = (info->shape && info->dimensions > 0)
+                              ? write_ints(w, info->shape, info->dimensions)
+                              : -1;
+            rec.attr[1] = info->dimensions;
+            rec.attr[2] = info->elem_num;
+            rec.attr[3] = info->values.ints ? write_ints(w, info->values.ints,
+                                                         info->value_count)
+                                            : -1;
+            rec.attr[4] = info->value_count;
+            break;
+        }
+        case SYMB_FUNCTION: {
+            FuncInfo* info = &sym->attributes.func_info;
+            rec.attr[0] = write_symbol_ids(w, info->params, info->param_count);
+            rec.attr[1] = info->param_count;
+            rec.attr[2] = write_symbol_ids(w, info->vars, info->var_count);
+            rec.attr[3] = info->var_count;
+            rec.attr[4] = info->call_count;
+            break;
+        }
+        default:
+            break;
+    }
+    buffer_append(out, &rec, sizeof(rec));
+}
+
+// Nodes are numbered in pre-order, so children always follow their parent
+static int32_t write_node(Writer* w, ASTNodePtr node) {
+    int32_t index = w->node_count++;
+    size_t rec_offset = buffer_append(&w->nodes, NULL, sizeof(SerialNode));
+    SerialNode rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.node_type = node->node_type;
+    rec.name = write_string(w, node->name);
+    rec.lineno = node->lineno;
+    rec.data_type = node->data_type;
+    switch (node->data_type) {
+        case NODEDATA_SYMB:
+            rec.data = node->data.symb_ptr ? node->data.symb_ptr->id : -1;
+            break;
+        case NODEDATA_INT:
+            rec.data = node->data.direct_int;
+            break;
+        case NODEDATA_FLOAT:
+            memcpy(&rec.data, &node->data.direct_float, sizeof(float));
+            break;
+        case NODEDATA_STRING:
+            rec.data = write_string(w, node->data.direct_str);
+            break;
+        case NODEDATA_TYPE:
+            rec.data = node->data.data_type;
+            break;
+        case NODEDATA_PACKED: {
+            PackedInitPtr packed = node->data.packed;
+            int32_t head[2] = {packed->elem_type, packed->length};
+            rec.data = write_ints(w, head, 2);
+            write_ints(w, packed->values.ints, packed->length);
+            write_ints(w, packed->expr_offsets, node->child_count);
+            break;
+        }
+        default:
+            break;
+    }
+    rec.child_count = node->child_count;
+    rec.first_child = (int32_t)(w->children.size / sizeof(int32_t));
+    size_t child_offset =
+        buffer_append(&w->children, NULL, node->child_count * sizeof(int32_t));
+
+    for (int i = 0; i < node->child_count; i++) {
+        int32_t child = node->children[i] ? write_node(w, node->children[i])
+                                          : -1;
+        memcpy(w->children.data + child_offset + i * sizeof(int32_t), &child,
+               sizeof(child));
+    }
+    memcpy(w->nodes.data + rec_offset, &rec, sizeof(rec));
+    return index;
+}
+
+static uint32_t align8(uint32_t offset) { return (offset + 7u) & ~7u; }
+
+int serialize_program(ASTNodePtr root, char** out, size_t* out_size) {
+    if (!root || !out || !out_size) return -1;
+
+    Writer w;
+    memset(&w, 0, sizeof(w));
+    Buffer symbols = {NULL, 0, 0};
+    int symbol_count = 0;
+    for (SymbolPtr sym; (sym = get_symbol_by_id(symbol_count)) != NULL;
+         symbol_count++)
+        write_symbol(&w, &symbols, sym);
+    int32_t root_index = write_node(&w, root);
+
+    SerialHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SERIAL_MAGIC, 4);
+    header.version = SERIAL_VERSION;
+    header.byte_order = SERIAL_BYTE_ORDER;
+    header.root = root_index;
+    header.symbol_count = symbol_count;
+    header.node_count = w.node_count;
+    header.child_count = (uint32_t)(w.children.size / sizeof(int32_t));
+    header.int_count = (uint32_t)(w.ints.size / sizeof(int32_t));
+    header.string_size = (uint32_t)w.strings.size;
+
+    header.symbol_offset = align8(sizeof(SerialHeader));
+    header.node_offset = align8(header.symbol_offset + symbols.size);
+    header.child_offset = align8(header.node_offset + w.nodes.size);
+    header.int_offset = align8(header.child_offset + w.children.size);
+    header.string_offset = align8(header.int_offset + w.ints.size);
+    size_t total = header.string_offset + w.strings.size;
+
+    char* image = (char*)calloc(1, total ? total : 1);
+    if (!image) {
+        fprintf(stderr, "Memory allocation failed for AST image\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(image, &header, sizeof(header));
+    if (symbols.size)
+        memcpy(image + header.symbol_offset, symbols.data, symbols.size);
+    if (w.nodes.size)
+        memcpy(image + header.node_offset, w.nodes.data, w.nodes.size);
+    if (w.children.size)
+        memcpy(image + header.child_offset, w.children.data, w.children.size);
+    if (w.ints.size)
+        memcpy(image + header.int_offset, w.ints.data, w.ints.size);
+    if (w.strings.size)
+        memcpy(image + header.string_offset, w.strings.data, w.strings.size);
+
+    free(symbols.data);
+    free(w.nodes.data);
+    free(w.children.data);
+    free(w.ints.data);
+    free(w.strings.data);
+
+    *out = image;
+    *out_size = total;
+    return 0;
+}
+
+// --- Reader ---
+
+typedef struct {
+    const SerialHeader* header;
+    const SerialSymbol* symbols;
+    const SerialNode* nodes;
+    const int32_t* children;
+    const int32_t* ints;
+    const char* strings;
+} Image;
+
+static int section_fits(size_t size, uint32_t offset, uint32_t count,
+                        size_t elem_size) {
+    return offset % 4 == 0 && offset <= size &&
+           (size - offset) / elem_size >= count;
+}
+
+// Returns a copy of the string at offset, or NULL for -1 / bad offsets
+static char* read_string(const Image* img, int32_t offset, int* ok) {
+    if (offset < 0) return NULL;
+    if ((uint32_t)offset >= img->header->string_size ||
+        !memchr(img->strings + offset, '\0',
+                img->header->string_size - offset)) {
+        *ok = 0;
+        return NULL;
+    }
+    return my_strdup(img->strings + offset);
+}
+
+static int ints_fit(const Image* img, int32_t index, int32_t count) {
+    return index >= 0 && count >= 0 &&
+           (uint32_t)index <= img->header->int_count &&
+           (uint32_t)count <= img->header->int_count - (uint32_t)index;
+}
+
+static SymbolPtr* read_symbol_ids(const Image* img, SymbolPtr* table,
+                                  int32_t index, int32_t count, int* ok) {
+    if (count <= 0 || index < 0) return NULL;
+    if (!ints_fit(img, index, count)) {
+        *ok = 0;
+        return NULL;
+    }
+    SymbolPtr* list = (SymbolPtr*)malloc(count * sizeof(SymbolPtr));
+    for (int i = 0; i < count; i++) {
+        int32_t id = img->ints[index + i];
+        if (id < -1 || id >= (int32_t)img->header->symbol_count) {
+            *ok = 0;
+            id = -1;
+        }
+        list[i] = id >= 0 ? table[id] : NULL;
+    }
+    return list;
+}
+
+static int read_symbols(const Image* img, SymbolPtr* table) {
+    uint32_t count = img->header->symbol_count;
+    int ok = 1;
+    for (uint32_t i = 0; i < count; i++) {
+        table[i] = (SymbolPtr)calloc(1, sizeof(Symbol));
+        if (!table[i]) {
+            fprintf(stderr, "Memory allocation failed for Symbol\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (uint32_t i = 0; i < count && ok; i++) {
+        const SerialSymbol* rec = &img->symbols[i];
+        SymbolPtr sym = table[i];
+        sym->id = (int)i;
+        sym->name = read_string(img, rec->name, &ok);
+        if (rec->function >= (int32_t)count) ok = 0;
+        sym->function = rec->function >= 0 && ok ? table[rec->function] : NULL;
+        sym->symbol_type = (SymbolType)rec->symbol_type;
+        sym->data_type = (DataType)rec->data_type;
+        sym->lineno = rec->lineno;
+        sym->scope_level = rec->scope_level;
+        sym->ref_count = rec->ref_count;
+
+        switch (sym->symbol_type) {
+            case SYMB_CONST_VAR:
+                sym->attributes.const_info.int_value = rec->attr[0];
+                memcpy(&sym->attributes.const_info.float_value, &rec->attr[1],
+                       sizeof(float));
+                break;
+            case SYMB_ARRAY:
+            case SYMB_CONST_ARRAY: {
+                ArrayInfo* info = &sym->attributes.array_info;
+                info->dimensions = rec->attr[1];
+                info->elem_num = rec->attr[2];
+                info->shape = NULL;
+                info->strides = NULL;
+                if (rec->attr[0] < 0 && info->dimensions > 0) ok = 0;
+                if (rec->attr[0] >= 0) {
+                    if (!ints_fit(img, rec->attr[0], info->dimensions)) {
+                        ok = 0;
+                        break;
+                    }
+                    info->shape = (int*)malloc(
+                        (info->dimensions > 0 ? info->dimensions : 1) *
+                        sizeof(int));
+                    memcpy(info->shape, img->ints + rec->attr[0],
+                           info->dimensions * sizeof(int));
+                    init_array_strides(info);
+                }
+                info->values.ints = NULL;
+                info->value_count = 0;
+                if (rec->attr[3] >= 0) {
+                    if (!ints_fit(img, rec->attr[3], rec->attr[4])) {
+                        ok = 0;
+                        break;
+                    }
+                    info->values.ints = (int*)malloc(
+                        (rec->attr[4] > 0 ? rec->attr[4] : 1) * sizeof(int));
+                    memcpy(info->values.ints, img->ints + rec->attr[3],
+                           rec->attr[4] * sizeof(int));
+                    info->value_count = rec->attr[4];
+                }
+                break;
+            }
+            case SYMB_FUNCTION: {
+                FuncInfo* info = &sym->attributes.func_info;
+                info->params = read_symbol_ids(img, table, rec->attr[0],
+                                               rec->attr[1], &ok);
+                info->param_count = info->params ? rec->attr[1] : 0;
+                info->vars = read_symbol_ids(img, table, rec->attr[2],
+                                             rec->attr[3], &ok);
+                info->var_count = info->vars ? rec->attr[3] : 0;
+                info->var_capacity = info->var_count;
+                info->call_count = rec->attr[4];
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return ok;
+}
+
+static PackedInitPtr read_packed(const Image* img, const SerialNode* rec,
+                                 int* ok) {
+    int32_t index = rec->data;
+    if (!ints_fit(img, index, 2) || rec->child_count < 0) {
+        *ok = 0;
+        return NULL;
+    }
+    int32_t length = img->ints[index + 1];
+    if (length < 0 || !ints_fit(img, index + 2, length) ||
+        !ints_fit(img, index + 2 + length, rec->child_count)) {
+        *ok = 0;
+        return NULL;
+    }
+    PackedInitPtr packed = (PackedInitPtr)calloc(1, sizeof(PackedInit));
+    packed->elem_type = (DataType)img->ints[index];
+    packed->length = length;
+    packed->capacity = length;
+    packed->values.ints = (int*)malloc((length ? length : 1) * sizeof(int));
+    memcpy(packed->values.ints, img->ints + index + 2, length * sizeof(int));
+    packed->expr_offsets = (int*)malloc(
+        (rec->child_count ? rec->child_count : 1) * sizeof(int));
+    for (int i = 0; i < rec->child_count; i++) {
+        packed->expr_offsets[i] = img->ints[index + 2 + length + i];
+        if (packed->expr_offsets[i] < 0) *ok = 0;
+    }
+    return packed;
+}
+
+static void free_packed(PackedInitPtr packed) {
+    if (!packed) return;
+    free(packed->values.ints);
+    free(packed->expr_offsets);
+    free(packed);
+}
+
+static int read_nodes(const Image* img, SymbolPtr* table, ASTNodePtr* nodes) {
+    uint32_t count = img->header->node_count;
+    int ok = 1;
+    char* has_parent = (char*)calloc(count ? count : 1, 1);
+    for (uint32_t i = 0; i < count && ok; i++) {
+        const SerialNode* rec = &img->nodes[i];
+        ASTNodePtr node = nodes[i];
+        node->node_type = (NodeType)rec->node_type;
+        node->name = read_string(img, rec->name, &ok);
+        node->lineno = rec->lineno;
+        node->data_type = (NodeDataType)rec->data_type;
+        switch (node->data_type) {
+            case NODEDATA_SYMB:
+                if (rec->data >= (int32_t)img->header->symbol_count) ok = 0;
+                node->data.symb_ptr =
+                    rec->data >= 0 && ok ? table[rec->data] : NULL;
+                break;
+            case NODEDATA_INT:
+                node->data.direct_int = rec->data;
+                break;
+            case NODEDATA_FLOAT:
+                memcpy(&node->data.direct_float, &rec->data, sizeof(float));
+                break;
+            case NODEDATA_STRING:
+                node->data.direct_str = read_string(img, rec->data, &ok);
+                break;
+            case NODEDATA_TYPE:
+                node->data.data_type = (DataType)rec->data;
+                break;
+            case NODEDATA_PACKED:
+                node->data.packed = read_packed(img, rec, &ok);
+                break;
+            default:
+                break;
+        }
+
+        if (rec->child_count < 0 || rec->first_child < 0 ||
+            (uint32_t)rec->first_child > img->header->child_count ||
+            (uint32_t)rec->child_count >
+                img->header->child_count - (uint32_t)rec->first_child) {
+            ok = 0;
+            break;
+        }
+        node->child_count = 0;
+        node->child_capacity = rec->child_count > 0 ? rec->child_count : 4;
+        node->children =
+            (ASTNodePtr*)malloc(node->child_capacity * sizeof(ASTNodePtr));
+        for (int c = 0; c < rec->child_count; c++) {
+            int32_t child = img->children[rec->first_child + c];
+            // Pre-order numbering: a child always comes after its parent and
+            // has exactly one parent, which rules out cycles and sharing
+            if (child != -1 &&
+                (child <= (int32_t)i || child >= (int32_t)count ||
+                 has_parent[child])) {
+                ok = 0;
+                break;
+            }
+            if (child >= 0) has_parent[child] = 1;
+            node->children[node->child_count++] =
+                child >= 0 ? nodes[child] : NULL;
+        }
+    }
+    // Every node except the root must hang off the tree
+    for (uint32_t i = 0; i < count && ok; i++)
+        if (!has_parent[i] && (int32_t)i != img->header->root) ok = 0;
+    free(has_parent);
+    return ok;
+}
+
+ASTNodePtr deserialize_program(const void* data, size_t size) {
+    if (!data || size < sizeof(SerialHeader)) return NULL;
+
+    Image img;
+    img.header = (const SerialHeader*)data;
+    const SerialHeader* h = img.header;
+    if (memcmp(h->magic, SERIAL_MAGIC, 4) != 0 ||
+        h->version != SERIAL_VERSION || h->byte_order != SERIAL_BYTE_ORDER)
+        return NULL;
+    if (!section_fits(size, h->symbol_offset, h->symbol_count,
+                      sizeof(SerialSymbol)) ||
+        !section_fits(size, h->node_offset, h->node_count,
+                      sizeof(SerialNode)) ||
+        !section_fits(size, h->child_offset, h->child_count,
+                      sizeof(int32_t)) ||
+        !section_fits(size, h->int_offset, h->int_count, sizeof(int32_t)) ||
+        !section_fits(size, h->string_offset, h->string_size, 1) ||
+        h->root < 0 || (uint32_t)h->root >= h->node_count)
+        return NULL;
+
+    const char* base = (const char*)data;
+    img.symbols = (const SerialSymbol*)(base + h->symbol_offset);
+    img.nodes = (const SerialNode*)(base + h->node_offset);
+    img.children = (const int32_t*)(base + h->child_offset);
+    img.ints = (const int32_t*)(base + h->int_offset);
+    img.strings = base + h->string_offset;
+
+    SymbolPtr* table =
+        (SymbolPtr*)malloc((h->symbol_count ? h->symbol_count : 1) *
+                           sizeof(SymbolPtr));
+    ASTNodePtr* nodes = (ASTNodePtr*)malloc(
+        (h->node_count ? h->node_count : 1) * sizeof(ASTNodePtr));
+    for (uint32_t i = 0; i < h->node_count; i++) {
+        nodes[i] = (ASTNodePtr)calloc(1, sizeof(ASTNode));
+        if (!nodes[i]) {
+            fprintf(stderr, "Memory allocation failed for ASTNode\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    int ok = read_symbols(&img, table) && read_nodes(&img, table, nodes);
+
+    ASTNodePtr root = NULL;
+    if (ok) {
+        for (uint32_t i = 0; i < h->symbol_count; i++) restore_symbol(table[i]);
+        root = nodes[h->root];
+    } else {
+        // Nodes are released one by one since the tree may be incomplete
+        for (uint32_t i = 0; i < h->node_count; i++) {
+            free(nodes[i]->children);
+            free(nodes[i]->name);
+            if (nodes[i]->data_type == NODEDATA_STRING)
+                free(nodes[i]->data.direct_str);
+            if (nodes[i]->data_type == NODEDATA_PACKED)
+                free_packed(nodes[i]->data.packed);
+            free(nodes[i]);
+        }
+        for (uint32_t i = 0; i < h->symbol_count; i++) {
+            free(table[i]->name);
+            free(table[i]);
+        }
+    }
+    free(table);
+    free(nodes);
+    return root;
+}
+
+int save_program(const char* path, ASTNodePtr root) {
+    char* image;
+    size_t size;
+    if (serialize_program(root, &image, &size) != 0) return -1;
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        free(image);
+        return -1;
+    }
+    int ok = fwrite(image, 1, size, file) == size;
+    ok = (fclose(file) == 0) && ok;
+    free(image);
+    return ok ? 0 : -1;
+}
+
+ASTNodePtr load_program(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    ASTNodePtr root = deserialize_program(data, st.st_size);
+    munmap(data, st.st_size);
+    return root;
+}
@@ -0,0 +1,175 @@
+#include "sy_parser/prescan.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void add_unit(TopLevelUnits* out, TopLevelUnit unit) {
+    if (out->unit_count >= out->unit_capacity) {
+        out->unit_capacity =
+            (out->unit_capacity == 0) ? 16 : out->unit_capacity * 2;
+        out->units = (TopLevelUnit*)realloc(
+            out->units, out->unit_capacity * sizeof(TopLevelUnit));
+        if (!out->units) {
+            fprintf(stderr, "Memory reallocation failed for prescan units\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    out->units[out->unit_count++] = unit;
+}
+
+static char* copy_name(const char* src, size_t begin, size_t len) {
+    char* name = (char*)malloc(len + 1);
+    if (!name) return NULL;
+    memcpy(name, src + begin, len);
+    name[len] = '\0';
+    return name;
+}
+
+int prescan_top_level(const char* src, size_t len, TopLevelUnits* out) {
+    size_t pos = 0;
+    int lineno = 1;
+    int paren_depth = 0, brace_depth = 0;
+    int in_unit = 0;
+    char last_sig = '\0';
+    // Last identifier outside any bracket, the candidate function name
+    size_t ident_begin = 0, ident_len = 0;
+    size_t name_begin = 0, name_len = 0;
+    TopLevelUnit unit;
+
+    out->units = NULL;
+    out->unit_count = 0;
+    out->unit_capacity = 0;
+    memset(&unit, 0, sizeof(unit));
+
+    while (pos < len) {
+        char c = src[pos];
+
+        // Whitespace
+        if (c == '\n') {
+            lineno++;
+            pos++;
+            continue;
+        }
+        if (isspace((unsigned char)c)) {
+            pos++;
+            continue;
+        }
+
+        // Comments
+        if (c == '/' && pos + 1 < len && src[pos + 1] == '/') {
+            while (pos < len && src[pos] != '\n') pos++;
+            continue;
+        }
+        if (c == '/' && pos + 1 < len && src[pos + 1] == '*') {
+            pos += 2;
+            while (pos + 1 < len && !(src[pos] == '*' && src[pos + 1] == '/')) {
+                if (src[pos] == '\n') lineno++;
+                pos++;
+            }
+            pos = (pos + 2 < len) ? pos + 2 : len;
+            continue;
+        }
+
+        // First significant character opens a new unit
+        if (!in_unit) {
+            in_unit = 1;
+            memset(&unit, 0, sizeof(unit));
+            unit.kind = UNIT_DECL;
+            unit.begin = pos;
+            unit.lineno = lineno;
+            last_sig = '\0';
+        }
+
+        // String literal
+        if (c == '"') {
+            pos++;
+            while (pos < len && src[pos] != '"') {
+                if (src[pos] == '\\' && pos + 1 < len) pos++;
+                if (src[pos] == '\n') lineno++;
+                pos++;
+            }
+            pos++;
+            last_sig = '"';
+            continue;
+        }
+
+        // Identifier or keyword
+        if (isalpha((unsigned char)c) || c == '_') {
+            size_t begin = pos;
+            while (pos < len &&
+                   (isalnum((unsigned char)src[pos]) || src[pos] == '_'))
+                pos++;
+            if (paren_depth == 0 && brace_depth == 0) {
+                ident_begin = begin;
+                ident_len = pos - begin;
+            }
+            last_sig = 'a';
+            continue;
+        }
+
+        switch (c) {
+            case '(':
+                if (paren_depth == 0 && brace_depth == 0) {
+                    name_begin = ident_begin;
+                    name_len = ident_len;
+                }
+                paren_depth++;
+                break;
+            case ')':
+                paren_depth--;
+                break;
+            case '{':
+                // '{' right after the parameter list opens a function body,
+                // otherwise it belongs to an initializer
+                if (brace_depth == 0 && paren_depth == 0 && last_sig == ')' &&
+                    unit.kind == UNIT_DECL) {
+                    unit.kind = UNIT_FUNC;
+                    unit.body_begin = pos;
+                    unit.body_lineno = lineno;
+                    unit.name = copy_name(src, name_begin, name_len);
+                }
+                brace_depth++;
+                break;
+            case '}':
+                brace_depth--;
+                if (brace_depth == 0 && unit.kind == UNIT_FUNC) {
+                    unit.end = pos + 1;
+                    add_unit(out, unit);
+                    in_unit = 0;
+                }
+                break;
+            case ';':
+                if (brace_depth == 0 && paren_depth == 0 &&
+                    unit.kind == UNIT_DECL) {
+                    unit.end = pos + 1;
+                    add_unit(out, unit);
+                    in_unit = 0;
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (paren_depth < 0 || brace_depth < 0) break;
+        last_sig = c;
+        pos++;
+    }
+
+    if (in_unit || paren_depth != 0 || brace_depth != 0) {
+        if (in_unit) free(unit.name);
+        free_top_level_units(out);
+        return -1;
+    }
+    return 0;
+}
+
+void free_top_level_units(TopLevelUnits* units) {
+    if (!units) return;
+    for (int i = 0; i < units->unit_count; i++) free(units->units[i].name);
+    free(units->units);
+    units->units = NULL;
+    units->unit_count = 0;
+    units->unit_capacity = 0;
+}
@@ -6,14 +6,23 @@
 
 #include "sy_parser/utils.h"
 
-// Symbol Table instance
-static SymbolTable permanent_table;
+// Symbol Table instance (on a worker, the symbols of the current body)
+static _Thread_local SymbolTable permanent_table;
 
 // Scope Stack instance
-static ScopeStack scope_stack;
+static _Thread_local ScopeStack scope_stack;
 
 // Function scope (in which function)
-static SymbolPtr func_scope;
+static _Thread_local SymbolPtr func_scope;
+
+// Function whose body a worker is parsing, NULL on the main thread
+static _Thread_local SymbolPtr body_func;
+
+// Count changes a worker made to globals, NULL on the main thread
+static _Thread_local GlobalCounts global_counts;
+
+static _Thread_local bool speculative_parse;
+static _Thread_local bool speculative_failed;
 
 void init_symbol_management() {
     permanent_table.symb_count = 0;
@@ -111,7 +120,7 @@ void add_symbol_to_current_scope(SymbolPtr symbol) {
     unsigned long index = my_str_hash(name) % current_scope->capacity;
     ScopeEntry* new_entry = (ScopeEntry*)malloc(sizeof(ScopeEntry));
     new_entry->name = my_strdup(name);
-    new_entry->symbol_id = symbol->id;
+    new_entry->symbol = symbol;
     new_entry->next = current_scope->entries[index];
     current_scope->entries[index] = new_entry;
 }
@@ -151,7 +160,7 @@ SymbolPtr lookup_symbol_in_scope(const char* name, Scope* scope) {
     ScopeEntry* entry = scope->entries[index];
     while (entry) {
         if (strcmp(entry->name, name) == 0) {
-            return permanent_table.symbols[entry->symbol_id];
+            return entry->symbol;
         }
         entry = entry->next;
     }
@@ -168,11 +177,18 @@ SymbolPtr lookup_symbol_in_current_scope(const char* name) {
 SymbolPtr define_symbol(const char* name, SymbolType sym_type,
                         DataType data_type, int lineno) {
     if (lookup_symbol_in_current_scope(name) != NULL) {
-        fprintf(stderr, "Error at line %d: Redeclaration of symbol '%s'\n",
-                lineno, name);
-        // In a real compiler we might try to recover, but here we'll exit.
-        exit(EXIT_FAILURE);
-        return NULL;
+        if (speculative_parse) {
+            // Keep going with a duplicate; the parse is redone serially
+            speculative_failed = true;
+        } else {
+            fprintf(stderr,
+                    "Error at line %d: Redeclaration of symbol '%s'\n",
+                    lineno, name);
+            // In a real compiler we might try to recover, but here we'll
+            // exit.
+            exit(EXIT_FAILURE);
+            return NULL;
+        }
     }
     SymbolPtr new_sym = (SymbolPtr)malloc(sizeof(Symbol));
     new_sym->id = permanent_table.symb_count;
@@ -182,8 +198,11 @@ SymbolPtr define_symbol(const char* name, SymbolType sym_type,
     new_sym->data_type = data_type;
     new_sym->lineno = lineno;
     new_sym->scope_level = get_current_scope_level();
+    new_sym->ref_count = 0;
 
-    // Initialize attributes union
+    // Initialize attributes union (zeroed first so that the value a const
+    // does not use, e.g. float_value of an int, is not left undefined)
+    memset(&new_sym->attributes, 0, sizeof(new_sym->attributes));
     if (sym_type == SYMB_FUNCTION) {
         FuncInfo func_info;
         func_info.params = NULL;
@@ -196,8 +215,11 @@ SymbolPtr define_symbol(const char* name, SymbolType sym_type,
     } else if (sym_type == SYMB_ARRAY || sym_type == SYMB_CONST_ARRAY) {
         ArrayInfo array_info;
         array_info.shape = NULL;
+        array_info.strides = NULL;
         array_info.dimensions = 0;
         array_info.elem_num = 1;
+        array_info.values.ints = NULL;
+        array_info.value_count = 0;
         new_sym->attributes.array_info = array_info;
     }
 
@@ -209,10 +231,33 @@ SymbolPtr define_symbol(const char* name, SymbolType sym_type,
     return new_sym;
 }
 
+void init_array_strides(ArrayInfo* array_info) {
+    int dimensions = array_info->dimensions;
+    if (!array_info->shape || dimensions <= 0) return;
+    free(array_info->strides);
+    array_info->strides = (int*)malloc(sizeof(int) * dimensions);
+    int stride = 1;
+    for (int i = dimensions - 1; i >= 0; i--) {
+        array_info->strides[i] = stride;
+        if (array_info->shape[i]) stride *= array_info->shape[i];
+    }
+}
+
+void restore_symbol(SymbolPtr symbol) {
+    symbol->id = permanent_table.symb_count;
+    add_symbol_to_symbol_table(symbol);
+    // Keep global names resolvable, as after a normal parse
+    if (symbol->scope_level == GLOBAL_SCOPE_LEVEL && scope_stack.top == 0)
+        add_symbol_to_current_scope(symbol);
+}
+
 SymbolPtr lookup_symbol(const char* name) {
     SymbolPtr symbol;
     for (int i = scope_stack.top; i >= 0; i--) {
         symbol = lookup_symbol_in_scope(name, scope_stack.scopes[i]);
+        // A worker sees only the globals defined before its function
+        if (symbol && i == 0 && body_func && symbol->id > body_func->id)
+            return NULL;
         if (symbol) {
             return symbol;
         }
@@ -220,6 +265,178 @@ SymbolPtr lookup_symbol(const char* name) {
     return NULL;
 }
 
+void count_symbol_ref(SymbolPtr symbol, int delta) {
+    if (global_counts.ref_counts && symbol->scope_level == GLOBAL_SCOPE_LEVEL)
+        global_counts.ref_counts[symbol->id] += delta;
+    else
+        symbol->ref_count += delta;
+}
+
+void count_function_call(SymbolPtr func_symb, int delta) {
+    if (global_counts.call_counts)
+        global_counts.call_counts[func_symb->id] += delta;
+    else
+        func_symb->attributes.func_info.call_count += delta;
+}
+
+void set_speculative_parse(bool speculative) {
+    speculative_parse = speculative;
+    speculative_failed = false;
+}
+
+bool is_speculative_parse() { return speculative_parse; }
+
+bool speculative_parse_failed() { return speculative_failed; }
+
+SymbolTableMark mark_symbol_table() {
+    SymbolTableMark mark;
+    int count = permanent_table.symb_count;
+    mark.symb_count = count;
+    mark.ref_counts = (int*)malloc(sizeof(int) * (count + 1));
+    mark.call_counts = (int*)malloc(sizeof(int) * (count + 1));
+    for (int i = 0; i < count; i++) {
+        SymbolPtr symbol = permanent_table.symbols[i];
+        mark.ref_counts[i] = symbol->ref_count;
+        mark.call_counts[i] = symbol->symbol_type == SYMB_FUNCTION
+                                  ? symbol->attributes.func_info.call_count
+                                  : 0;
+    }
+    return mark;
+}
+
+void reset_symbol_table(SymbolTableMark* mark) {
+    while (scope_stack.top >= 0) exit_scope();
+    func_scope = NULL;
+    for (int i = mark->symb_count; i < permanent_table.symb_count; i++) {
+        free(permanent_table.symbols[i]->name);
+        free(permanent_table.symbols[i]);
+    }
+    permanent_table.symb_count = mark->symb_count;
+
+    enter_scope();
+    for (int i = 0; i < mark->symb_count; i++) {
+        SymbolPtr symbol = permanent_table.symbols[i];
+        symbol->ref_count = mark->ref_counts[i];
+        if (symbol->symbol_type == SYMB_FUNCTION)
+            symbol->attributes.func_info.call_count = mark->call_counts[i];
+        if (symbol->scope_level == GLOBAL_SCOPE_LEVEL)
+            add_symbol_to_current_scope(symbol);
+    }
+    free_symbol_table_mark(mark);
+}
+
+void free_symbol_table_mark(SymbolTableMark* mark) {
+    free(mark->ref_counts);
+    free(mark->call_counts);
+    mark->ref_counts = mark->call_counts = NULL;
+}
+
+Scope* get_global_scope() {
+    return scope_stack.top >= 0 ? scope_stack.scopes[0] : NULL;
+}
+
+int get_symbol_count() { return permanent_table.symb_count; }
+
+void begin_worker_symbols(Scope* global_scope, int global_count) {
+    permanent_table.symb_count = 0;
+    permanent_table.symb_capacity = 0;
+    permanent_table.symbols = NULL;
+
+    // The shared global scope is pushed but never freed by this thread
+    scope_stack.capacity = 16;
+    scope_stack.scopes = (Scope**)malloc(scope_stack.capacity * sizeof(Scope*));
+    scope_stack.scopes[0] = global_scope;
+    scope_stack.top = 0;
+    func_scope = NULL;
+
+    global_counts.symb_count = global_count;
+    global_counts.ref_counts = (int*)calloc(global_count + 1, sizeof(int));
+    global_counts.call_counts = (int*)calloc(global_count + 1, sizeof(int));
+}
+
+GlobalCounts end_worker_symbols() {
+    GlobalCounts counts = global_counts;
+    while (scope_stack.top > 0) exit_scope();
+    free(scope_stack.scopes);
+    scope_stack.scopes = NULL;
+    scope_stack.top = -1;
+    global_counts.ref_counts = global_counts.call_counts = NULL;
+    global_counts.symb_count = 0;
+    return counts;
+}
+
+void enter_function_body(SymbolPtr func_symb) {
+    FuncInfo* func_info = &func_symb->attributes.func_info;
+    permanent_table.symb_count = 0;
+    permanent_table.symb_capacity = 16;
+    permanent_table.symbols =
+        (Symbol**)malloc(permanent_table.symb_capacity * sizeof(SymbolPtr));
+
+    // Parameter scope, as left by function_def in a serial parse
+    enter_scope();
+    for (int i = 0; i < func_info->param_count; i++)
+        add_symbol_to_current_scope(func_info->params[i]);
+    enter_function(func_symb);
+    body_func = func_symb;
+}
+
+BodySymbols exit_function_body() {
+    BodySymbols body;
+    body.func = body_func;
+    body.symbols = permanent_table.symbols;
+    body.symb_count = permanent_table.symb_count;
+
+    while (scope_stack.top > 0) exit_scope();
+    exit_function();
+    body_func = NULL;
+    permanent_table.symbols = NULL;
+    permanent_table.symb_count = 0;
+    permanent_table.symb_capacity = 0;
+    return body;
+}
+
+void merge_body_symbols(BodySymbols* bodies, int body_count,
+                        GlobalCounts* counts, int counts_count) {
+    for (int c = 0; c < counts_count; c++) {
+        for (int i = 0; i < counts[c].symb_count; i++) {
+            SymbolPtr symbol = permanent_table.symbols[i];
+            symbol->ref_count += counts[c].ref_counts[i];
+            if (symbol->symbol_type == SYMB_FUNCTION)
+                symbol->attributes.func_info.call_count +=
+                    counts[c].call_counts[i];
+        }
+        free(counts[c].ref_counts);
+        free(counts[c].call_counts);
+        counts[c].ref_counts = counts[c].call_counts = NULL;
+    }
+
+    int total = permanent_table.symb_count;
+    for (int b = 0; b < body_count; b++) total += bodies[b].symb_count;
+    Symbol** merged = (Symbol**)malloc((total + 1) * sizeof(SymbolPtr));
+    int merged_count = 0, next_body = 0;
+    for (int i = 0; i < permanent_table.symb_count; i++) {
+        SymbolPtr symbol = permanent_table.symbols[i];
+        merged[merged_count++] = symbol;
+        if (next_body >= body_count || bodies[next_body].func != symbol)
+            continue;
+        // Parameters follow their function, the body's symbols come next
+        while (i + 1 < permanent_table.symb_count &&
+               permanent_table.symbols[i + 1]->function == symbol)
+            merged[merged_count++] = permanent_table.symbols[++i];
+        BodySymbols* body = &bodies[next_body++];
+        for (int j = 0; j < body->symb_count; j++)
+            merged[merged_count++] = body->symbols[j];
+        free(body->symbols);
+        body->symbols = NULL;
+    }
+    for (int i = 0; i < merged_count; i++) merged[i]->id = i;
+
+    free(permanent_table.symbols);
+    permanent_table.symbols = merged;
+    permanent_table.symb_count = merged_count;
+    permanent_table.symb_capacity = total + 1;
+}
+
 const char* symbol_type_to_string(SymbolType type) {
     switch (type) {
         case SYMB_VAR:
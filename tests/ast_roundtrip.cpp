@@ -0,0 +1,142 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "IR/IRPrinter.h"
+#include "IR/Module.h"
+#include "ir_gen.h"
+#include "ir_incremental.h"
+#include "runtime_lib_def.h"
+
+extern "C" {
+#include "sy_parser/AST.h"
+#include "sy_parser/ast_serialize.h"
+#include "sy_parser/parse.h"
+#include "sy_parser/symbol_table.h"
+
+extern ASTNodePtr root;
+}
+
+// Capture print_ast and print_symbol_table output as a string
+static std::string dump_program(ASTNodePtr program) {
+    fflush(stdout);
+    FILE* tmp = tmpfile();
+    int saved = dup(fileno(stdout));
+    dup2(fileno(tmp), fileno(stdout));
+    print_ast(program, 0);
+    print_symbol_table();
+    fflush(stdout);
+    dup2(saved, fileno(stdout));
+    close(saved);
+
+    std::string text;
+    char buf[4096];
+    size_t n;
+    rewind(tmp);
+    while ((n = fread(buf, 1, sizeof(buf), tmp)) > 0) text.append(buf, n);
+    fclose(tmp);
+    return text;
+}
+
+// Every global of a loaded table must resolve by name, as after a parse
+static bool globals_resolvable() {
+    for (int id = 0;; id++) {
+        SymbolPtr sym = get_symbol_by_id(id);
+        if (!sym) return true;
+        if (sym->scope_level == GLOBAL_SCOPE_LEVEL &&
+            lookup_symbol(sym->name) != sym)
+            return false;
+    }
+}
+
+// IR of the source file, lowered without printing the debug dumps
+static std::string lower_source(const char* path) {
+    FILE* file_in = fopen(path, "r");
+    if (!file_in) return std::string();
+    IncrementalState state;
+    bool ok = regenerate_IR(file_in, FrontendOptions(), state);
+    fclose(file_in);
+    return ok ? midend::IRPrinter::toString(state.module.get())
+              : std::string();
+}
+
+static double elapsed_us(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - begin)
+        .count();
+}
+
+// Parse -> serialize -> load -> serialize again, comparing both images and
+// both dumps, then lower the image and the source and compare the IR.
+// Prints image size, parse time and load time.
+static bool roundtrip(const char* path) {
+    FILE* file_in = fopen(path, "r");
+    if (!file_in) {
+        perror(path);
+        return false;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    init_symbol_management();
+    add_runtime_lib_to_symbol_table();
+    int parse_result = parse_file(file_in, &root);
+    double parse_us = elapsed_us(begin);
+    fclose(file_in);
+    if (parse_result || !root) {
+        printf("%-32s parse failed\n", path);
+        free_symbol_management();
+        return false;
+    }
+
+    std::string expected = dump_program(root);
+    char* image;
+    size_t size;
+    serialize_program(root, &image, &size);
+    free_ast(root);
+    root = NULL;
+    free_symbol_management();
+
+    begin = std::chrono::steady_clock::now();
+    init_symbol_management();
+    ASTNodePtr loaded = deserialize_program(image, size);
+    double load_us = elapsed_us(begin);
+
+    bool ok = loaded != NULL;
+    if (ok) {
+        char* image2;
+        size_t size2;
+        serialize_program(loaded, &image2, &size2);
+        ok = size2 == size && memcmp(image, image2, size) == 0 &&
+             dump_program(loaded) == expected && globals_resolvable();
+        free(image2);
+        free_ast(loaded);
+    }
+    free_symbol_management();
+
+    // The loaded image lowers to the same IR as its source
+    if (ok) {
+        auto module = generate_IR_from_ast(image, size, FrontendOptions());
+        ok = module &&
+             midend::IRPrinter::toString(module.get()) == lower_source(path);
+    }
+    free(image);
+
+    printf("%-32s %8zu bytes  parse %9.1f us  load %9.1f us  %s\n", path, size,
+           parse_us, load_us, ok ? "OK" : "MISMATCH");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <file.sy>...\n", argv[0]);
+        return 1;
+    }
+    int failed = 0;
+    for (int i = 1; i < argc; i++)
+        if (!roundtrip(argv[i])) failed++;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "IR/Module.h"
+#include "ir_gen.h"
+
+// Source with `breaks` break statements (and as many continues) spread over
+// a nest of `depth` while loops
+static std::string make_source(int breaks, int depth) {
+    std::string source = "int main() {\n    int s = 0;\n";
+    for (int d = 0; d < depth; d++) {
+        std::string i = "i" + std::to_string(d);
+        source += "    int " + i + " = 0;\n";
+        source += "    while (" + i + " < 10) {\n";
+        source += "        " + i + " = " + i + " + 1;\n";
+    }
+    for (int b = 0; b < breaks; b++) {
+        source += "        if (s == " + std::to_string(b) + ") break;\n";
+        source += "        if (s > " + std::to_string(b) + ") continue;\n";
+    }
+    for (int d = 0; d < depth; d++) source += "        s = s + 1;\n    }\n";
+    source += "    return s;\n}\n";
+    return source;
+}
+
+// Time IR generation for programs with a growing number of breaks. The time
+// per break should stay flat as the count grows.
+int main(int argc, char** argv) {
+    int max_breaks = argc > 1 ? atoi(argv[1]) : 32000;
+    int depth = argc > 2 ? atoi(argv[2]) : 2;
+
+    // The generator prints the AST and IR in debug builds
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    for (int breaks = 1000; breaks <= max_breaks; breaks *= 2) {
+        std::string source = make_source(breaks, depth);
+        FILE* file_in = fmemopen(&source[0], source.size(), "r");
+        if (!file_in) return 1;
+
+        auto begin = std::chrono::steady_clock::now();
+        auto module = generate_IR(file_in, FrontendOptions());
+        double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - begin)
+                        .count();
+        fclose(file_in);
+        if (!module) {
+            fprintf(stderr, "IR generation failed for %d breaks\n", breaks);
+            return 1;
+        }
+        fprintf(stderr, "%6d breaks: %9.1f ms, %6.2f us/break\n", breaks, ms,
+                ms * 1000 / breaks);
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <cstdio>
+#include <string>
+
+#include "IR/IRPrinter.h"
+#include "IR/Module.h"
+#include "ir_incremental.h"
+
+// Regenerate one version of the program into state
+static bool regenerate(const char* path, const FrontendOptions& options,
+                       IncrementalState& state, IncrementalStats* stats) {
+    FILE* file_in = fopen(path, "r");
+    if (!file_in) {
+        perror(path);
+        return false;
+    }
+    bool ok = regenerate_IR(file_in, options, state, stats);
+    fclose(file_in);
+    return ok && state.module;
+}
+
+// Feed the versions to one IncrementalState in order and compare the IR after
+// each update with a fresh compile of the same version
+static int check_sequence(int count, char** paths, const char* config,
+                          const FrontendOptions& options) {
+    IncrementalState state;
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        IncrementalStats stats = {0, 0, false};
+        IncrementalState fresh;
+        bool ok = regenerate(paths[i], options, state, &stats) &&
+                  regenerate(paths[i], options, fresh, nullptr) &&
+                  midend::IRPrinter::toString(state.module.get()) ==
+                      midend::IRPrinter::toString(fresh.module.get());
+        printf("%-40s %-8s reused %2d  relowered %2d%s  %s\n", paths[i],
+               config, stats.reused, stats.relowered,
+               stats.full_rebuild ? " (full)" : "       ",
+               ok ? "OK" : "MISMATCH");
+        if (!ok) failed++;
+    }
+    return failed;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <version0.sy> <version1.sy>...\n", argv[0]);
+        return 1;
+    }
+    FrontendOptions plain;
+    FrontendOptions ssa;
+    ssa.direct_ssa = true;
+    ssa.branch_conditions = true;
+    ssa.rotate_loops = true;
+    ssa.const_eval_steps = 1000;
+    ssa.prune_unreachable = true;
+    ssa.elide_unused = true;
+    // Options whose lowering creates module entities on demand: memset and
+    // memcpy declarations, array templates and memo tables
+    FrontendOptions lazy;
+    lazy.array_zero_fill = ArrayZeroFill::Coverage;
+    lazy.memset_threshold = 8;
+    lazy.array_template_min = 4;
+    lazy.memo_table_size = 64;
+
+    int failed = check_sequence(argc - 1, argv + 1, "plain", plain) +
+                 check_sequence(argc - 1, argv + 1, "ssa", ssa) +
+                 check_sequence(argc - 1, argv + 1, "lazy", lazy);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "parallel_parse.h"
+#include "runtime_lib_def.h"
+
+extern "C" {
+#include "sy_parser/AST.h"
+#include "sy_parser/ast_serialize.h"
+#include "sy_parser/symbol_table.h"
+}
+
+// One parse of a program: the print_ast and print_symbol_table dumps and the
+// binary AST image, which also holds every node's line number and every
+// symbol field (function, scope level, counts, parameters and locals)
+struct ParseResult {
+    bool ok = false;
+    std::string dump;
+    std::string image;
+    ParallelParseStats stats = {0, true};
+    double parse_ms = 0;
+};
+
+static std::string dump_program(ASTNodePtr program) {
+    fflush(stdout);
+    FILE* tmp = tmpfile();
+    int saved = dup(fileno(stdout));
+    dup2(fileno(tmp), fileno(stdout));
+    print_ast(program, 0);
+    print_symbol_table();
+    fflush(stdout);
+    dup2(saved, fileno(stdout));
+    close(saved);
+
+    std::string text;
+    char buf[4096];
+    size_t n;
+    rewind(tmp);
+    while ((n = fread(buf, 1, sizeof(buf), tmp)) > 0) text.append(buf, n);
+    fclose(tmp);
+    return text;
+}
+
+static ParseResult parse(const std::string& source, int threads, bool dump) {
+    ParseResult result;
+    init_symbol_management();
+    add_runtime_lib_to_symbol_table();
+    ASTNodePtr program = nullptr;
+    auto begin = std::chrono::steady_clock::now();
+    result.ok = !parse_source(source, threads, &program, &result.stats) &&
+                program;
+    result.parse_ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+    if (result.ok) {
+        if (dump) result.dump = dump_program(program);
+        char* image;
+        size_t size;
+        serialize_program(program, &image, &size);
+        result.image.assign(image, size);
+        free(image);
+    }
+    if (program) free_ast(program);
+    free_symbol_management();
+    return result;
+}
+
+// Parse serially and on 2, 4 and 8 threads; the results must be identical.
+// With expect_parallel the threaded parses must not fall back to serial.
+static bool check(const char* name, const std::string& source,
+                  bool expect_parallel) {
+    ParseResult serial = parse(source, 1, true);
+    bool ok = true;
+    int bodies = 0;
+    for (int threads = 2; threads <= 8; threads *= 2) {
+        ParseResult parallel = parse(source, threads, true);
+        ok = ok && parallel.ok == serial.ok && parallel.dump == serial.dump &&
+             parallel.image == serial.image;
+        if (expect_parallel && parallel.stats.serial) ok = false;
+        bodies = parallel.stats.bodies;
+    }
+    printf("%-40s %s, %4d bodies on workers  %s\n", name,
+           serial.ok ? "parsed" : "failed", bodies, ok ? "OK" : "MISMATCH");
+    return ok;
+}
+
+static bool read_file(const char* path, std::string& source) {
+    FILE* file_in = fopen(path, "r");
+    if (!file_in) {
+        perror(path);
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file_in)) > 0)
+        source.append(buf, n);
+    fclose(file_in);
+    return true;
+}
+
+// A program of `functions` functions with globals between them. Bodies use
+// nested scopes shadowing globals, arrays, consts folded at parse time,
+// calls to earlier functions, starttime/stoptime line numbers, and comments
+// and strings around line breaks.
+static std::string make_source(int functions) {
+    std::string source = "const int N = 8;\nint g0 = 1;\n";
+    for (int f = 0; f < functions; f++) {
+        std::string id = std::to_string(f);
+        source += "int g" + std::to_string(f + 1) + "[N] = {" + id + "};\n";
+        source += "/* function " + id + "\n */\n";
+        source += "int f" + id + "(int a, int b[]) {\n";
+        source += "    const int k = N * 2; // folded\n";
+        source += "    int g" + id + " = a + k, s[N][2] = {{1}, {2, 3}};\n";
+        source += "    int i = 0;\n    starttime();\n";
+        source += "    while (i < N) {\n";
+        source += "        int a = b[i] + s[i / 2][i % 2];\n";
+        source += "        if (a > g" + id + " && i != 3) g" + id +
+                  " = g" + id + " + a;\n";
+        source += "        else { putf(\"%d\\n\", a); }\n";
+        source += "        i = i + 1;\n    }\n    stoptime();\n";
+        // The global array defined just before the function, then the local
+        std::string global = "g" + std::to_string(f + 1) + "[1]";
+        if (f > 0)
+            source += "    return f" + std::to_string(f - 1) + "(g" + id +
+                      " + " + global + ", b);\n";
+        else
+            source += "    return g" + id + " + " + global + ";\n";
+        source += "}\n";
+    }
+    source += "int main() {\n    int b[N];\n    return f" +
+              std::to_string(functions - 1) + "(getint(), b);\n}\n";
+    return source;
+}
+
+// Parse time of the generated program by thread count, best of 5. Threads
+// beyond the hardware's only add overhead.
+static void measure(int functions) {
+    std::string source = make_source(functions);
+    double serial_ms = 0;
+    printf("Parse time, %d functions (%zu bytes), %u hardware threads:\n",
+           functions, source.size(), std::thread::hardware_concurrency());
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        double best = 0;
+        for (int r = 0; r < 5; r++) {
+            double ms = parse(source, threads, false).parse_ms;
+            if (r == 0 || ms < best) best = ms;
+        }
+        if (threads == 1) serial_ms = best;
+        printf("  %d thread%s %9.2f ms  x%.2f\n", threads,
+               threads == 1 ? " " : "s", best, serial_ms / best);
+    }
+}
+
+// Compare threaded parses of each file and of generated programs with the
+// serial parse, then print parse times of a large generated program
+int main(int argc, char** argv) {
+    int failed = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string source;
+        if (!read_file(argv[i], source) || !check(argv[i], source, false))
+            failed++;
+    }
+
+    if (!check("generated (200 functions)", make_source(200), true))
+        failed++;
+    // A body referring to a global defined after its function fails
+    // serially and must fail on the workers too
+    if (!check("later global",
+               "int f() { return g; }\nint g;\nint main() { return f(); }\n",
+               false))
+        failed++;
+    if (!check("shadowed later global",
+               "int f() { int g = 1; return g; }\n"
+               "int g = 2;\nint main() { return f() + g; }\n",
+               true))
+        failed++;
+
+    measure(4000);
+    return failed ? 1 : 0;
+}
@@ -1,26 +1,198 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 
+#include "IR/BasicBlock.h"
+#include "IR/Function.h"
 #include "IR/IRPrinter.h"
 #include "IR/Module.h"
+#include "ir_annotations.h"
+#include "ir_cache.h"
 #include "ir_gen.h"
 
 void test();
 
+// 输出前端记录的循环结构
+void print_loop_info(midend::Module* module) {
+    for (auto func : *module) {
+        const FunctionLoops* loops = get_loop_annotations(module, func);
+        if (!loops) continue;
+        for (size_t i = 0; i < loops->size(); i++) {
+            const LoopAnnotation& loop = (*loops)[i];
+            fprintf(stderr, "loop %s#%zu: header %s, exit %s, %zu blocks, ",
+                    func->getName().c_str(), i,
+                    loop.header->getName().c_str(),
+                    loop.exit ? loop.exit->getName().c_str() : "none",
+                    loop.blocks.size());
+            fprintf(stderr, "%zu latches, depth %d, parent %d",
+                    loop.latches.size(), loop.depth, loop.parent);
+            if (loop.induction)
+                fprintf(stderr, ", iv %s < %d, trip count %lld",
+                        loop.induction->getName().c_str(), loop.bound,
+                        (long long)loop.trip_count);
+            fprintf(stderr, "\n");
+        }
+    }
+}
+
+// 输出前端分析得到的函数属性
+void print_func_attributes(midend::Module* module) {
+    for (auto func : *module) {
+        const FunctionAttributes* attributes =
+            get_function_attributes(module, func);
+        if (!attributes) continue;
+        fprintf(stderr, "attributes %s:", func->getName().c_str());
+        if (attributes->readnone) fprintf(stderr, " readnone");
+        if (attributes->readonly) fprintf(stderr, " readonly");
+        if (attributes->norecurse) fprintf(stderr, " norecurse");
+        for (size_t i = 0; i < attributes->params.size(); i++) {
+            const ParamAttributes& param = attributes->params[i];
+            if (!param.noalias && !param.readonly) continue;
+            fprintf(stderr, ", param %zu", i);
+            if (param.noalias) fprintf(stderr, " noalias");
+            if (param.readonly) fprintf(stderr, " readonly");
+        }
+        fprintf(stderr, "\n");
+    }
+}
+
+// 输出各函数的栈帧估计
+void print_stack_report(midend::Module* module) {
+    for (auto func : *module) {
+        const StackEstimate* estimate = get_stack_estimate(module, func);
+        if (!estimate) continue;
+        fprintf(stderr, "stack %s: frame %lld bytes, largest array %lld",
+                func->getName().c_str(), (long long)estimate->frame_bytes,
+                (long long)estimate->largest_array_bytes);
+        fprintf(stderr, ", static %lld\n", (long long)estimate->static_bytes);
+    }
+}
+
 int main(int argc, char** argv) {
+    FrontendOptions options;
+    const char* input_path = nullptr;
+    const char* bin_path = nullptr;
+    bool keep_local_names = true;
+    bool loop_info = false;
+    bool func_attributes = false;
+    bool stack_report = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            options.cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--emit-bin") == 0 && i + 1 < argc) {
+            bin_path = argv[++i];
+        } else if (strcmp(argv[i], "--strip-names") == 0) {
+            keep_local_names = false;
+        } else if (strcmp(argv[i], "--zero-fill-coverage") == 0) {
+            options.array_zero_fill = ArrayZeroFill::Coverage;
+        } else if (strcmp(argv[i], "--memset-threshold") == 0 &&
+                   i + 1 < argc) {
+            options.memset_threshold = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--array-template-min") == 0 &&
+                   i + 1 < argc) {
+            options.array_template_min = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--packed-init-min") == 0 &&
+                   i + 1 < argc) {
+            options.packed_init_min = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--address-lowering") == 0 &&
+                   i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "multi-index") == 0)
+                options.address_lowering = AddressLowering::MultiIndex;
+            else if (strcmp(mode, "flattened") == 0)
+                options.address_lowering = AddressLowering::Flattened;
+            else
+                options.address_lowering = AddressLowering::PerDimension;
+        } else if (strcmp(argv[i], "--fold-array-offsets") == 0) {
+            options.fold_array_offsets = true;
+        } else if (strcmp(argv[i], "--direct-ssa") == 0) {
+            options.direct_ssa = true;
+        } else if (strcmp(argv[i], "--branch-conditions") == 0) {
+            options.branch_conditions = true;
+        } else if (strcmp(argv[i], "--rotate-loops") == 0) {
+            options.rotate_loops = true;
+        } else if (strcmp(argv[i], "--simplify-exps") == 0) {
+            options.simplify_exps = true;
+        } else if (strcmp(argv[i], "--const-eval-steps") == 0 &&
+                   i + 1 < argc) {
+            options.const_eval_steps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--const-eval-depth") == 0 &&
+                   i + 1 < argc) {
+            options.const_eval_depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--memo-table-size") == 0 &&
+                   i + 1 < argc) {
+            options.memo_table_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--prune-unreachable") == 0) {
+            options.prune_unreachable = true;
+        } else if (strcmp(argv[i], "--elide-unused") == 0) {
+            options.elide_unused = true;
+        } else if (strcmp(argv[i], "--no-readonly-globals") == 0) {
+            options.detect_readonly_globals = false;
+        } else if (strcmp(argv[i], "--static-array-min-bytes") == 0 &&
+                   i + 1 < argc) {
+            options.static_array_min_bytes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--parse-threads") == 0 && i + 1 < argc) {
+            options.parse_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stack-report") == 0) {
+            stack_report = true;
+        } else if (strcmp(argv[i], "--loop-info") == 0) {
+            loop_info = true;
+        } else if (strcmp(argv[i], "--func-attributes") == 0) {
+            func_attributes = true;
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            // 未知选项或缺少取值的选项，不能当作输入文件
+            fprintf(stderr, "Unknown option or missing value: %s\n", argv[i]);
+            fprintf(stderr, "Usage: %s [options] [file.sy]\n", argv[0]);
+            return 1;
+        } else {
+            input_path = argv[i];
+        }
+    }
+
     FILE* file_in = nullptr;
-    if (argc > 1) {
-        file_in = fopen(argv[1], "r");
+    if (input_path) {
+        file_in = fopen(input_path, "r");
         if (!file_in) {
-            perror(argv[1]);
+            perror(input_path);
             return 1;
         }
     } else {
         file_in = stdin;
     }
 
-    generate_IR(file_in);
+    auto module = generate_IR(file_in, options);
+
+    // 写出二进制IR，并与文本IR比较大小
+    if (bin_path && module) {
+        std::string data;
+        write_module_binary(module.get(), data, keep_local_names);
+        size_t text_size = midend::IRPrinter::toString(module.get()).size();
+        FILE* bin_out = fopen(bin_path, "wb");
+        if (!bin_out) {
+            perror(bin_path);
+            return 1;
+        }
+        fwrite(data.data(), 1, data.size(), bin_out);
+        fclose(bin_out);
+        fprintf(stderr, "IR handoff: text %zu bytes, binary %zu bytes\n",
+                text_size, data.size());
+    }
+
+    if (loop_info && module) print_loop_info(module.get());
+    if (func_attributes && module) print_func_attributes(module.get());
+    if (stack_report && module) print_stack_report(module.get());
+    const std::vector<std::string>* pruned =
+        module ? get_pruned_definitions(module.get()) : nullptr;
+    if (pruned)
+        for (const std::string& name : *pruned)
+            fprintf(stderr, "pruned %s\n", name.c_str());
+
+    if (!options.cache_dir.empty()) {
+        const IRCacheStats& stats = get_ir_cache_stats();
+        fprintf(stderr, "IR cache: %d hits, %d misses, %d stores, %d errors\n",
+                stats.hits, stats.misses, stats.stores, stats.errors);
+    }
 
     if (file_in && file_in != stdin) fclose(file_in);
     return 0;
@@ -1,20 +1,25 @@
-target("parser")
-    set_kind("binary")
-    set_languages("c11", "c++17")
-    
-    add_files("parser.cpp")
-    
-    add_deps("frontend")
-    
-    set_warnings("all")
-    add_cxflags("-Wall", "-Wextra")
-    
-    if is_mode("debug") then
-        add_cflags("-g", "-O0")
-        set_symbols("debug")
-        set_optimize("none")
-    elseif is_mode("release") then
-        add_cflags("-O3", "-DNDEBUG")
-        set_symbols("hidden")
-        set_optimize("fastest")
-    end
+-- The parser driver and the test/benchmark tools share one configuration
+for _, name in ipairs({"parser", "ast_roundtrip", "break_bench", "incremental_check",
+                       "parallel_parse"}) do
+    target(name)
+        set_kind("binary")
+        set_languages("c11", "c++17")
+
+        add_files(name .. ".cpp")
+
+        add_deps("frontend")
+
+        set_warnings("all")
+        add_cxflags("-Wall", "-Wextra")
+
+        if is_mode("debug") then
+            add_cflags("-g", "-O0")
+            set_symbols("debug")
+            set_optimize("none")
+        elseif is_mode("release") then
+            add_cflags("-O3", "-DNDEBUG")
+            set_symbols("hidden")
+            set_optimize("fastest")
+        end
+    target_end()
+end
@@ -95,8 +95,17 @@ target("frontend")
         "src/sy_parser/utils.c",
         "src/sy_parser/AST.c",
         "src/sy_parser/symbol_table.c",
+        "src/sy_parser/prescan.c",
+        "src/sy_parser/ast_serialize.c",
         "src/runtime_lib_def.cpp",
         "src/ir_gen.cpp",
+        "src/ir_serialize.cpp",
+        "src/ir_cache.cpp",
+        "src/ir_incremental.cpp",
+        "src/parallel_parse.cpp",
+        "src/ir_annotations.cpp",
+        "src/const_eval.cpp",
+        "src/func_effects.cpp",
         "flex_yacc/sysy_yacc.y",
         "flex_yacc/sysy_flex.l",
         "src/sy_parser/y.tab.c",
@@ -108,6 +117,11 @@ target("frontend")
     add_includedirs("include/sy_parser", {public = true})
     
     add_headerfiles("include/(**.h)")
+
+    -- Function bodies may be parsed on worker threads (parse_threads)
+    if is_plat("linux", "macosx") then
+        add_syslinks("pthread", {public = true})
+    end
     
     set_warnings("all")
     add_cflags("-Wall", "-Wextra")
@@ -297,8 +311,18 @@ task("test")
             io.write(string.format("Testing %-30s ... ", basename))
             io.flush()
             
+            -- Options for this case, one per whitespace-separated word
+            local args = {}
+            local flags_file = path.join(cases_dir, path.basename(sy_file) .. ".flags")
+            if os.isfile(flags_file) then
+                for arg in io.readfile(flags_file):gmatch("%S+") do
+                    table.insert(args, arg)
+                end
+            end
+            table.insert(args, sy_file)
+
             -- Run parser and capture output
-            local outdata, errdata = os.iorunv(parser_exe, {sy_file})
+            local outdata, errdata = os.iorunv(parser_exe, args)
             
             -- Check if .out file exists
             if os.isfile(out_file) then
@@ -333,6 +357,54 @@ task("test")
         print("=" .. string.rep("=", 50))
         print(string.format("Tests: %d total, %d passed, %d failed", 
                            #test_files, passed_count, #failed_tests))
+
+        -- Binary AST round-trip on the same cases
+        task.run("build", {target="ast_roundtrip"})
+        local roundtrip_exe = project.target("ast_roundtrip"):targetfile()
+        print("Running binary AST round-trip...")
+        local ok = try { function ()
+            os.execv(roundtrip_exe, test_files)
+            return true
+        end }
+        if not ok then
+            cprint("${red}Binary AST round-trip failed")
+            table.insert(failed_tests, "ast_roundtrip")
+        end
+
+        -- Parses with function bodies on worker threads against serial
+        -- parses of the same cases, then parse times by thread count
+        task.run("build", {target="parallel_parse"})
+        local parallel_exe = project.target("parallel_parse"):targetfile()
+        print("Running parallel parse checks...")
+        local ok = try { function ()
+            os.execv(parallel_exe, test_files)
+            return true
+        end }
+        if not ok then
+            cprint("${red}Parallel parse check failed")
+            table.insert(failed_tests, "parallel_parse")
+        end
+
+        -- Incremental updates against fresh compiles: each directory under
+        -- tests/incremental holds versions 0.sy, 1.sy, ... of one program
+        task.run("build", {target="incremental_check"})
+        local incremental_exe = project.target("incremental_check"):targetfile()
+        local incremental_dir = path.join(script_dir, "tests", "incremental")
+        print("Running incremental update checks...")
+        for _, dir in ipairs(os.dirs(path.join(incremental_dir, "*"))) do
+            local versions = os.files(path.join(dir, "*.sy"))
+            table.sort(versions, function (a, b)
+                return tonumber(path.basename(a)) < tonumber(path.basename(b))
+            end)
+            local ok = try { function ()
+                os.execv(incremental_exe, versions)
+                return true
+            end }
+            if not ok then
+                cprint("${red}Incremental update check failed: %s", path.filename(dir))
+                table.insert(failed_tests, "incremental/" .. path.filename(dir))
+            end
+        end
         
         if #failed_tests > 0 then
             cprint("${red}Failed tests:")